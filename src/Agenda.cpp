@@ -0,0 +1,229 @@
+#include "Agenda.h"
+
+Agenda::Agenda(Database* db_ptr, Config* cfg_ptr) {
+    database_ptr = db_ptr;
+    config_ptr = cfg_ptr;
+
+    focused = false;
+    open_day = Calendar::today();
+    focus_row = -1;
+
+    win = nullptr;
+    win_height = win_width = win_top_y = win_left_x = 0;
+    last_state = "";
+}
+
+// public
+void Agenda::open(time_t from) {
+    open_day = Calendar::day_of(from);
+    focus_row = -1; // placed a third of the way down on the next draw
+
+    std::vector<Block> blocks = database_ptr->get_blocks_after({ from, -1 }, 1);
+    if (blocks.empty()) blocks = database_ptr->get_blocks_before({ from, -1 }, 1);
+
+    focused = !blocks.empty();
+    if (focused) focus = blocks[0];
+}
+
+// public
+void Agenda::move_focus(int blocks) {
+    if (!focused || blocks == 0) return;
+
+    std::vector<Block> passed = (blocks > 0)?
+        database_ptr->get_blocks_after(focus_key(), blocks)
+      : database_ptr->get_blocks_before(focus_key(), -blocks);
+    if (passed.empty()) return;
+
+    focus = passed.back();
+    focus_row += (blocks > 0)? passed.size() : -passed.size(); // kept in bounds when drawn
+}
+
+// public
+void Agenda::move_focus_days(int days) {
+    if (!focused) return;
+
+    for (; days > 0; days--) {
+        std::vector<Block> next = database_ptr->get_blocks_after(
+            { Calendar::midnight(focus.get_day() + 1), -1 }, 1);
+        if (next.empty()) return;
+
+        focus = next[0];
+        focus_row++;
+    }
+
+    for (; days < 0; days++) {
+        // the last block of an earlier day, then the first block of that day
+        std::vector<Block> previous = database_ptr->get_blocks_before(
+            { Calendar::midnight(focus.get_day()), -1 }, 1);
+        if (previous.empty()) {
+            std::vector<Block> first = database_ptr->get_blocks_after(
+                { Calendar::midnight(focus.get_day()), -1 }, 1);
+            if (!first.empty()) focus = first[0]; // the first day, its top at least
+
+            return;
+        }
+
+        focus = database_ptr->get_blocks_after(
+            { Calendar::midnight(previous[0].get_day()), -1 }, 1)[0];
+        focus_row--;
+    }
+}
+
+// public
+void Agenda::scroll_pages(int half_pages) {
+    move_focus(half_pages * std::max(1, win_height / 2));
+}
+
+// public
+bool Agenda::has_focus() const { return focused; }
+
+// public
+Block Agenda::get_focused_block() const { return focus; }
+
+// public
+int Agenda::get_focused_day() const { return focused? focus.get_day() : open_day; }
+
+// public
+std::string Agenda::get_focus_summary() const {
+    if (!focused) return "no blocks";
+
+    int day = focus.get_day();
+    return format_day(day, config_ptr->day_format) + " " + format_day(day, config_ptr->date_format)
+         + "  " + focus.get_duration_str() + "  " + focus.get_title();
+}
+
+// public
+void Agenda::invalidate() { last_state = ""; }
+
+// public
+void Agenda::draw(int height, int width, int top_y, int left_x) {
+    if (win == nullptr || win_height != height || win_width != width
+        || win_top_y != top_y || win_left_x != left_x) {
+        if (win != nullptr) delwin(win);
+
+        win = newwin(height, width, top_y, left_x);
+        win_height = height; win_width = width;
+        win_top_y = top_y; win_left_x = left_x;
+        last_state = "";
+    }
+
+    // the blocks can't change while the agenda is up, only where it is
+    if (get_state() == last_state) return;
+
+    werase(win);
+
+    if (!focused) {
+        std::string text = "nothing planned";
+        mvwaddstr(win, height / 2, std::max(0, (int) (width - text.size()) / 2), text.c_str());
+    }
+
+    std::vector<row> rows = build_rows(height);
+
+    for (int y = 0; y < (int) rows.size(); y++)
+        draw_row(rows[y], y, width, y == focus_row);
+
+    last_state = get_state(); // with focus_row as it was put in bounds
+
+    wnoutrefresh(win); // pushed to the screen in doupdate
+}
+
+// private
+Database::block_key Agenda::focus_key() const {
+    return { focus.get_time_t_start(), focus.get_track() };
+}
+
+// private
+std::string Agenda::get_state() const {
+    return std::to_string(focused) + "\n" + std::to_string(focus.get_time_t_start()) + "\n"
+         + std::to_string(focus.get_track()) + "\n" + std::to_string(focus_row) + "\n"
+         + std::to_string(Calendar::today());
+}
+
+// private
+std::vector<Agenda::row> Agenda::build_rows(int height) {
+    std::vector<row> rows;
+    if (!focused || height <= 0) return rows;
+
+    // a few rows stay visible on either side of the focus while there are more
+    int margin = std::min(3, (height - 1) / 2);
+    if (focus_row < 0) focus_row = height / 3;
+    focus_row = std::clamp(focus_row, margin, std::max(margin, height - 1 - margin));
+
+    // upwards from the focus, nearest first, a header where the day changes
+    std::vector<row> above;
+    int day = focus.get_day();
+
+    for (const Block& block : database_ptr->get_blocks_before(focus_key(), focus_row)) {
+        if (block.get_day() != day) {
+            above.push_back({ day, true, Block() });
+            day = block.get_day();
+        }
+
+        if ((int) above.size() >= focus_row) break;
+        above.push_back({ day, false, block });
+    }
+
+    // fewer rows than were asked for means the list started, which is under a header too
+    if ((int) above.size() < focus_row) above.push_back({ day, true, Block() });
+    focus_row = above.size();
+
+    rows.assign(above.rbegin(), above.rend());
+    rows.push_back({ focus.get_day(), false, focus });
+
+    day = focus.get_day();
+    for (const Block& block : database_ptr->get_blocks_after(focus_key(),
+                                                              height - rows.size())) {
+        if (block.get_day() != day) {
+            day = block.get_day();
+            rows.push_back({ day, true, Block() });
+        }
+
+        if ((int) rows.size() >= height) break;
+        rows.push_back({ day, false, block });
+    }
+
+    return rows;
+}
+
+// private
+void Agenda::draw_row(const row& r, int y, int width, bool focused_row) {
+    if (r.header) {
+        bool today = r.day == Calendar::today();
+        std::string text = format_day(r.day, config_ptr->day_format) + " "
+                         + format_day(r.day, config_ptr->date_format);
+
+        if (today) wattron(win, COLOR_PAIR(config_ptr->colors.today));
+        wattron(win, A_BOLD);
+        mvwaddnstr(win, y, 0, text.c_str(), text.size());
+        wattroff(win, A_BOLD);
+        if (today) wattroff(win, COLOR_PAIR(config_ptr->colors.today));
+
+        return;
+    }
+
+    const Block& block = r.block;
+    std::string prefix = "  " + block.get_t_start_hour_str() + "-"
+                       + block.get_t_end_hour_str() + (block.get_important()? " ! " : "   ");
+
+    // the title takes what is left of the line, cut at a character
+    const std::vector<std::string>& title = Wrap::wrap(block.get_title(),
+                                                       width - (int) prefix.size());
+
+    wattron(win, COLOR_PAIR(block.get_color()));
+    if (focused_row) wattron(win, A_REVERSE);
+
+    std::string line = prefix + title[0];
+    mvwaddnstr(win, y, 0, line.c_str(), line.size());
+
+    wattroff(win, A_REVERSE);
+    wattroff(win, COLOR_PAIR(block.get_color()));
+}
+
+// private
+std::string Agenda::format_day(int day, const std::string& format) const {
+    char buffer[64];
+    struct tm date = Calendar::to_tm(day);
+    std::strftime(buffer, sizeof(buffer), format.c_str(), &date);
+
+    return std::string(buffer);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Database.h"
+#include "Config.h"
+#include "Calendar.h"
+#include "Wrap.h"
+
+// #include "include/curses.h"
+#include <ncursesw/ncurses.h>
+#include <string>
+#include <vector>
+
+// the blocks one per line in start order, under a header for each day they are on
+// only the rows on screen are built, by walking the database from the focused block
+// both ways, so a frame costs the same however far it was scrolled
+class Agenda {
+public:
+    Agenda(Database* db_ptr, Config* cfg_ptr);
+
+    void open(time_t from); // focus the first block from this time on (or the last before)
+    void move_focus(int blocks); // stops at the first and last block
+    void move_focus_days(int days); // to the first block of the next day with blocks (or back)
+    void scroll_pages(int half_pages); // the focus moves along with the page
+
+    bool has_focus() const; // false if there are no blocks at all
+    Block get_focused_block() const;
+    int get_focused_day() const; // the day it was opened on when there are no blocks
+    std::string get_focus_summary() const; // one line about the focused block, for the bar
+
+    // draws into its own window (without doupdate), only if something changed
+    void draw(int height, int width, int top_y, int left_x);
+    void invalidate(); // redraw next frame
+
+private:
+    Database* database_ptr;
+    Config* config_ptr;
+
+    bool focused; // whether there is a focused block
+    Block focus;
+    int open_day; // for when there is no focus
+    int focus_row; // the row the focus is kept on while it moves, like a cursor
+
+    struct row {
+        int day; // a header for this day, or the day of the block
+        bool header;
+        Block block;
+    };
+
+    WINDOW* win;
+    int win_height, win_width, win_top_y, win_left_x;
+    std::string last_state; // everything the last draw depended on (empty forces a draw)
+
+    Database::block_key focus_key() const;
+    std::string get_state() const; // what the rows on screen depend on
+    // the rows on screen, with the focus on focus_row (moved up when it is near the start)
+    std::vector<row> build_rows(int height);
+    void draw_row(const row& r, int y, int width, bool focused_row);
+    std::string format_day(int day, const std::string& format) const; // strftime
+};
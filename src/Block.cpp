@@ -19,9 +19,9 @@ Block::Block(std::filesystem::path savefile, Config* cfg_ptr) {
     std::string current_line;
     int linenum = 0;
 
-    hour_format = cfg_ptr->str({"ui", "date_formats", "hour_format"});
-    parse_format = cfg_ptr->str({"ui", "date_formats", "parse_format"});
-    save_path = cfg_ptr->str({"save_path"});
+    hour_format = cfg_ptr->hour_format;
+    parse_format = cfg_ptr->parse_format;
+    save_path = cfg_ptr->save_path.string();
 
     while (file) {
         std::getline(file, current_line); linenum++;
@@ -36,25 +36,28 @@ Block::Block(std::filesystem::path savefile, Config* cfg_ptr) {
 }
 
 Block::Block(Config* cfg_ptr, int id_) {
-    title = cfg_ptr->str({"ui", "boxdrawing", "highlight_fill"});
+    title = cfg_ptr->highlight_fill;
     error_str = "block initialized from scratch";
     for (size_t i = 0; i < field_count; i++) modified[i] = false;
     link = "";
     link_type = LINK_NA;
     id = id_;
     group = 0;
+    track = 0;
     color = 0;
     collapsible = false;
     important = false;
     time_t now = time(0); t_start = *std::localtime(&now);
     duration = 60;
+    recur_days = 0;
+    skip_days = {};
 
-    hour_format = cfg_ptr->str({"ui", "date_formats", "hour_format"});
-    parse_format = cfg_ptr->str({"ui", "date_formats", "parse_format"});
+    hour_format = cfg_ptr->hour_format;
+    parse_format = cfg_ptr->parse_format;
 
     modified[FLD_TITLE] = true;
     source_file = "";
-    save_path = cfg_ptr->str({"save_path"});
+    save_path = cfg_ptr->save_path.string();
 }
 
 Block::Block(const Block& other) {
@@ -65,9 +68,11 @@ Block::Block() {
     for (size_t i = 0; i < field_count; i++) modified[i] = false;
     parse_format = hour_format = title = error_str = link = "";
     link_type = LINK_NA;
-    id = group = color = duration = 0;
+    id = group = track = color = duration = 0;
     collapsible = important = false;
     t_start = {0};
+    recur_days = 0;
+    skip_days = {};
     source_file = "/";
 }
 
@@ -145,6 +150,29 @@ void Block::init_field(std::string name, std::string contents, std::string error
         strptime(contents.c_str(), parse_format.c_str(), &t_start);
         t_start.tm_isdst = -1; // set to noop so mktime sets it
         std::mktime(&t_start);
+    } else if (name == "recur") {
+        boost::algorithm::trim_if(contents, boost::algorithm::is_any_of("\""));
+        if (contents.size() != 7) throw std::runtime_error
+            (error + ", recur needs a letter for each day from monday: " + contents);
+
+        recur_days = 0;
+        for (int i = 0; i < 7; i++)
+            if (std::isupper((unsigned char) contents[i])) recur_days |= 1 << i;
+    } else if (name == "skip") {
+        std::istringstream dates(contents);
+        std::string date_str;
+
+        while (dates >> date_str) {
+            struct tm date = {0};
+            const char* end = strptime(date_str.c_str(), "%d.%m.%Y", &date);
+            if (end == nullptr || *end != '\0') throw std::runtime_error
+                (error + ", can't parse skipped date: " + date_str);
+
+            skip_days.push_back(Calendar::days_from_civil(date.tm_year + 1900,
+                                                          date.tm_mon + 1, date.tm_mday));
+        }
+
+        std::sort(skip_days.begin(), skip_days.end());
     } else if (name == "group") {
         try {
             group = std::stoi(contents);
@@ -152,6 +180,13 @@ void Block::init_field(std::string name, std::string contents, std::string error
             throw std::runtime_error
                 (error + ", can't parse group id into integer: " + contents);
         }
+    } else if (name == "track") {
+        try {
+            track = std::stoi(contents);
+        } catch (const std::exception& e) {
+            throw std::runtime_error
+                (error + ", can't parse track into integer: " + contents);
+        }
     } else if (name == "color") {
         color = -1;
         for (size_t i = 0; i < 8; i++) {
@@ -214,10 +249,13 @@ void Block::init_fields() {
     color = 0;
     id = 0;
     group = 0;
+    track = 0;
     collapsible = false;
     important = false;
     t_start = {0};
     duration = 0;
+    recur_days = 0;
+    skip_days = {};
     std::fill(modified, modified + field_count, false);
 }
 
@@ -230,11 +268,13 @@ void Block::dump_info() const {
     std::cout << "link_type: " << link_type << std::endl;
     std::cout << "color: " << color << std::endl;
     std::cout << "group: " << group << std::endl;
+    std::cout << "track: " << track << std::endl;
     std::cout << "collapsible: " << collapsible << std::endl;
     std::cout << "important: " << important << std::endl;
     std::cout << "start: " << get_t_start_str() << std::endl;
     std::cout << "start hr: " << get_t_start_hour_str() << std::endl;
     std::cout << "duration: " << get_duration_str() << std::endl;
+    std::cout << "recur: " << recur_days << ", skipping " << skip_days.size() << std::endl;
 }
 
 // public
@@ -290,8 +330,11 @@ bool Block::follow_link() const {
 // public
 void Block::save_to_file() {
     if (modified[FLD_TITLE] || modified[FLD_ID]) {
-        if (source_file.string() == "") {
-            source_file = save_path + "/TMPFILE.norg";
+        bool has_file = source_file.string() != "";
+
+        if (!has_file) {
+            // named after the id, so new blocks can be written side by side
+            source_file = save_path + "/TMPFILE" + std::to_string(id) + ".norg";
             std::ofstream tmp_ofstream(source_file);
 
             tmp_ofstream << "@document.meta" << std::endl;
@@ -306,7 +349,9 @@ void Block::save_to_file() {
         std::filesystem::path new_file = save_path + "/"
                                        + title + "." + std::to_string(id) + ".norg";
 
-        if (modified[FLD_ID]) { // means a copy was made and so we leave old file intact
+        // a new id means a copy was made and so we leave old file intact
+        // (unless the file is just the template of a new block)
+        if (modified[FLD_ID] && has_file) {
             std::filesystem::copy(source_file, new_file);
         } else {
             std::rename(source_file.string().c_str(), new_file.string().c_str());
@@ -324,8 +369,10 @@ void Block::save_to_file() {
                            modified[FLD_COLOR] ||
                            modified[FLD_COLLAPSIBLE] ||
                            modified[FLD_IMPORTANT] ||
+                           modified[FLD_TRACK] ||
                            modified[FLD_START] ||
-                           modified[FLD_DURATION];
+                           modified[FLD_DURATION] ||
+                           modified[FLD_RECUR];
 
     if (writing_to_file) {
         std::ifstream infile;
@@ -344,7 +391,8 @@ void Block::save_to_file() {
     if (modified[FLD_LINK] ||
         modified[FLD_COLOR] ||
         modified[FLD_COLLAPSIBLE] ||
-        modified[FLD_IMPORTANT]) {
+        modified[FLD_IMPORTANT] ||
+        modified[FLD_TRACK]) {
 
         bool in_block = false;
         std::string line;
@@ -367,6 +415,8 @@ void Block::save_to_file() {
                         file_vec[i] += "collapsible:\n";
                     if (modified[FLD_IMPORTANT] && important)
                         file_vec[i] += "important:\n";
+                    if (modified[FLD_TRACK] && track != 0)
+                        file_vec[i] += "track: " + std::to_string(track) + "\n";
 
                     file_vec[i] += "@end";
                     break;
@@ -375,7 +425,8 @@ void Block::save_to_file() {
                 if ((line.find("color:")       == 0 && modified[FLD_COLOR]) ||
                     (line.find("link:")        == 0 && modified[FLD_LINK]) ||
                     (line.find("collapsible:") == 0 && modified[FLD_COLLAPSIBLE]) ||
-                    (line.find("important:")   == 0 && modified[FLD_IMPORTANT])) {
+                    (line.find("important:")   == 0 && modified[FLD_IMPORTANT]) ||
+                    (line.find("track:")       == 0 && modified[FLD_TRACK])) {
 
                     file_vec.erase(file_vec.begin() + i);
                     i--;
@@ -384,7 +435,7 @@ void Block::save_to_file() {
         }
     }
 
-    if (modified[FLD_START] || modified[FLD_DURATION]) {
+    if (modified[FLD_START] || modified[FLD_DURATION] || modified[FLD_RECUR]) {
         bool in_block = false;
         std::string line;
 
@@ -402,13 +453,19 @@ void Block::save_to_file() {
                         file_vec[i] += "start = " + get_t_start_str() + "\n";
                     if (modified[FLD_DURATION])
                         file_vec[i] += "duration = " + get_duration_str() + "\n";
+                    if (modified[FLD_RECUR] && recur_days != 0)
+                        file_vec[i] += "recur = " + get_recur_str() + "\n";
+                    if (modified[FLD_RECUR] && !skip_days.empty())
+                        file_vec[i] += "skip = " + get_skip_str() + "\n";
 
                     file_vec[i] += "@end";
                     break;
                 }
 
                 if ((line.find("start") == 0 && modified[FLD_START]) ||
-                    (line.find("duration") == 0 && modified[FLD_DURATION])) {
+                    (line.find("duration") == 0 && modified[FLD_DURATION]) ||
+                    (line.find("recur") == 0 && modified[FLD_RECUR]) ||
+                    (line.find("skip") == 0 && modified[FLD_RECUR])) {
 
                     file_vec.erase(file_vec.begin() + i);
                     i--;
@@ -432,8 +489,10 @@ void Block::save_to_file() {
         modified[FLD_COLOR] =
         modified[FLD_COLLAPSIBLE] =
         modified[FLD_IMPORTANT] =
+        modified[FLD_TRACK] =
         modified[FLD_START] =
-        modified[FLD_DURATION] = false;
+        modified[FLD_DURATION] =
+        modified[FLD_RECUR] = false;
     }
 }
 
@@ -443,6 +502,7 @@ void Block::integrity_check() const {
     duration_integrity(duration);
     id_integrity(id);
     group_integrity(group);
+    track_integrity(track);
     color_integrity(color);
     source_file_integrity(source_file);
 }
@@ -476,6 +536,12 @@ void Block::group_integrity(int val) const {
         (error_str+", group is out of range [0, 99999] ("+std::to_string(val)+")");
 }
 
+void Block::track_integrity(int val) const {
+    if (val < 0 || val >= TRACK_COUNT) throw std::runtime_error
+        (error_str+", track is out of range [0, "+std::to_string(TRACK_COUNT - 1)
+         +"] ("+std::to_string(val)+")");
+}
+
 void Block::color_integrity(int val) const {
     if (val < 0 || val > 7) throw std::runtime_error
         (error_str+", color is out of range [0, 7] ("+std::to_string(val)+")");
@@ -532,18 +598,46 @@ int Block::get_color() const { return color; }
 std::filesystem::path Block::get_source_file() const { return source_file; }
 std::string Block::get_link() const { return link; }
 Block::en_link_type Block::get_link_type() const { return link_type; }
+int Block::get_group() const { return group; }
+int Block::get_track() const { return track; }
 
-time_t Block::get_time_t_start() const {
-    struct tm copy = t_start;
-    return std::mktime(&copy);
+bool Block::is_recurring() const { return recur_days != 0; }
+
+bool Block::recurs_on(int day) const {
+    int weekday = (Calendar::weekday(day) + 6) % 7; // monday first
+    if (!(recur_days & (1 << weekday)) || day < get_day()) return false;
+
+    return !std::binary_search(skip_days.begin(), skip_days.end(), day);
+}
+
+Block Block::occurrence_on(int day) const {
+    Block occurrence = *this;
+
+    struct tm date = Calendar::to_tm(day);
+    date.tm_hour = t_start.tm_hour;
+    date.tm_min = t_start.tm_min;
+    date.tm_sec = t_start.tm_sec;
+    date.tm_isdst = -1;
+    std::mktime(&date);
+
+    occurrence.t_start = date;
+    occurrence.group = id;
+    occurrence.recur_days = 0;
+    occurrence.skip_days = {};
+    std::fill(occurrence.modified, occurrence.modified + field_count, false);
+
+    return occurrence;
 }
 
-time_t Block::get_date_time() const {
+time_t Block::get_time_t_start() const {
     struct tm copy = t_start;
-    copy.tm_hour = copy.tm_min = copy.tm_sec = 0;
     return std::mktime(&copy);
 }
 
+time_t Block::get_date_time() const { return Calendar::midnight(get_day()); }
+
+int Block::get_day() const { return Calendar::day_of(t_start); }
+
 
 time_t Block::get_time_t_end() const { return get_time_t_start() + duration; }
 
@@ -601,15 +695,62 @@ void Block::set_collapsible(bool coll) {
     modified[FLD_COLLAPSIBLE] = true;
 }
 
+void Block::set_group(int new_group) {
+    group = new_group;
+    group_integrity(group);
+}
+
+void Block::set_track(int new_track) {
+    track = new_track;
+    modified[FLD_TRACK] = true;
+    track_integrity(track);
+}
+
+void Block::skip_day(int day) {
+    auto it = std::lower_bound(skip_days.begin(), skip_days.end(), day);
+    if (it == skip_days.end() || *it != day) skip_days.insert(it, day);
+
+    modified[FLD_RECUR] = true;
+}
+
+// private
+std::string Block::get_recur_str() const {
+    const std::string letters = "mtwtfss";
+    std::string str = "\"";
+
+    for (int i = 0; i < 7; i++)
+        str += (recur_days & (1 << i))? (char) std::toupper(letters[i]) : letters[i];
+
+    return str + "\"";
+}
+
+// private
+std::string Block::get_skip_str() const {
+    std::string str;
+
+    for (int day : skip_days) {
+        char buffer[16];
+        struct tm date = Calendar::to_tm(day);
+        std::strftime(buffer, sizeof(buffer), "%d.%m.%Y", &date);
+
+        str += (str.empty()? "" : " ") + std::string(buffer);
+    }
+
+    return str;
+}
+
 bool operator==(const Block& l, const Block& r) {
     return l.get_time_t_start() == r.get_time_t_start()
     && l.get_time_t_end()   == r.get_time_t_end()
     && l.get_id()           == r.get_id()
+    && l.get_track()        == r.get_track()
     && l.get_title()        == r.get_title()
     && l.get_collapsible()  == r.get_collapsible()
     && l.get_important()    == r.get_important()
     && l.get_color()        == r.get_color()
-    && l.get_source_file()  == r.get_source_file();
+    && l.get_source_file()  == r.get_source_file()
+    && l.recur_days         == r.recur_days
+    && l.skip_days          == r.skip_days;
 }
 
 bool operator!=(const Block& l, const Block& r) { return !(l == r); }
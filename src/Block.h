@@ -1,20 +1,25 @@
 #pragma once
 
 #include "Config.h"
+#include "Calendar.h"
 
 #include <vector>
 #include <filesystem>
 #include <ncursesw/ncurses.h>
 #include <boost/algorithm/string/trim.hpp>
+#include <boost/algorithm/string/classification.hpp>
 #include <ctime>
 #include <fstream>
 #include <iostream>
 #include <cstdio>
 #include <regex>
+#include <sstream>
+#include <algorithm>
 
 class Block {
 public:
     enum en_link_type { LINK_NA, LINK_FILE, LINK_HTTP, LINK_TASK };
+    static const int TRACK_COUNT = 4; // blocks side by side at most (quadrants of a day)
 
     Block(std::filesystem::path savefile, Config* cfg_ptr);
     Block(Config* cfg_ptr, int id_); // id is the only necessary field
@@ -45,10 +50,18 @@ public:
     bool get_important() const;
     time_t get_duration() const;
     time_t get_date_time() const;
+    int get_day() const; // civil day number (see Calendar)
     int get_color() const;
     std::filesystem::path get_source_file() const;
     std::string get_link() const;
     en_link_type get_link_type() const;
+    int get_group() const; // the id of the series an occurrence came from, 0 otherwise
+    int get_track() const; // only blocks on different tracks may overlap
+
+    bool is_recurring() const; // whether this is the rule of a series (see occurrence_on)
+    bool recurs_on(int day) const; // on one of its weekdays, not before it starts, not skipped
+    // a copy on another day at the same wall clock time, without a file of its own
+    Block occurrence_on(int day) const;
 
     void set_title(std::string new_title);
     void set_id(int new_id);
@@ -58,6 +71,9 @@ public:
     void set_color_str(std::string col);
     void set_important(bool imp);
     void set_collapsible(bool coll);
+    void set_group(int new_group);
+    void set_track(int new_track);
+    void skip_day(int day); // leave an occurrence out of the series
 
     void toggle_important();
     void toggle_collapsible();
@@ -75,11 +91,14 @@ public:
             link_type = other.link_type;
             id = other.id;
             group = other.group;
+            track = other.track;
             color = other.color;
             collapsible = other.collapsible;
             important = other.important;
             t_start = other.t_start;
             duration = other.duration;
+            recur_days = other.recur_days;
+            skip_days = other.skip_days;
             source_file = other.source_file;
             hour_format = other.hour_format;
             parse_format = other.parse_format;
@@ -95,10 +114,10 @@ private:
     std::string error_str; // the intro to all errors
     std::string save_path;
     
-    const int field_count = 8; // the number of fields
-    bool modified[8]; // keeping track of which fields have been modified
+    const int field_count = 10; // the number of fields
+    bool modified[10]; // keeping track of which fields have been modified
     enum en_fields { FLD_ID, FLD_TITLE, FLD_LINK, FLD_COLOR, FLD_COLLAPSIBLE,
-                     FLD_IMPORTANT, FLD_START, FLD_DURATION };
+                     FLD_IMPORTANT, FLD_START, FLD_DURATION, FLD_RECUR, FLD_TRACK };
     
     std::string link; // can be "", a file path, http link, or an id of a task
     en_link_type link_type; // the type of link we have from the above options
@@ -107,6 +126,7 @@ private:
     int group; // if the task was created as a recurring one
                // it should have a groupid matching all of the other occurrences
                // otherwise it should have a groupid of zero
+    int track; // 0 to TRACK_COUNT-1, blocks only collide with the ones on their track
 
     int color; // 0-7 corresponding to the color the task should have in ui
     const std::string color_names[8] = { "white", "red", "green", "yellow",
@@ -120,6 +140,11 @@ private:
     struct tm t_start;
     time_t duration;
 
+    // recur = "MTWTFss": capitals are the weekdays it repeats on, bit 0 is monday
+    // 0 for blocks that happen once
+    int recur_days;
+    std::vector<int> skip_days; // sorted civil days the series leaves out (skip = dd.mm.yyyy ...)
+
     std::string parse_format; // for parsing / writing save files
     std::string hour_format; // for ui
 
@@ -128,6 +153,9 @@ private:
     enum en_parsing_block { BLK_META, BLK_TIME, BLK_NA };
 
     void init_fields(); // populate fields with default values
+
+    std::string get_recur_str() const; // as saved, like "MTWTFss"
+    std::string get_skip_str() const;
  
     void parse_filename(std::string filename); // populate the id & title fields
     
@@ -152,6 +180,7 @@ private:
     void duration_integrity(time_t val) const;
     void id_integrity(int val) const;
     void group_integrity(int val) const;
+    void track_integrity(int val) const;
     void color_integrity(int val) const;
     void source_file_integrity(std::filesystem::path val) const;
 };
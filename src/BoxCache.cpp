@@ -0,0 +1,95 @@
+#include "BoxCache.h"
+
+BoxCache::BoxCache(Config* cfg_ptr) {
+    config_ptr = cfg_ptr;
+    loaded = false;
+}
+
+BoxCache::BoxCache() {
+    config_ptr = nullptr;
+    loaded = false;
+}
+
+// public
+const BoxCache::box_rows& BoxCache::get_rows(en_box_type type, bool filled, int width) {
+    if (!loaded) load_glyphs();
+
+    std::unordered_map<int, box_rows>& width_cache = row_cache[type][filled];
+
+    auto it = width_cache.find(width);
+    if (it == width_cache.end())
+        it = width_cache.emplace(width, build_rows(glyph_table[type][filled], width)).first;
+
+    return it->second;
+}
+
+// public
+void BoxCache::clear() {
+    loaded = false;
+
+    for (int type = 0; type < 3; type++)
+        for (int filled = 0; filled < 2; filled++)
+            row_cache[type][filled].clear();
+}
+
+// private
+void BoxCache::load_glyphs() {
+    const std::string& highlight_fill = config_ptr->highlight_fill;
+    const std::string& focus_fill = config_ptr->background_focus_fill;
+
+    for (int type = 0; type < 3; type++) {
+        const Config::box_glyphs& box = config_ptr->boxes[type];
+
+        glyph_set glyphs;
+        glyphs.tl = box.tl;
+        glyphs.tr = box.tr;
+        glyphs.bl = box.bl;
+        glyphs.br = box.br;
+        glyphs.hz = box.hz;
+        glyphs.vr = box.vr;
+        glyphs.fill = glyphs.alt_fill = box.fill;
+        glyphs.checkered = false;
+
+        glyph_table[type][false] = glyphs;
+
+        if (type == BOX_BACKGROUND) {
+            // a focused day is checkered in between the rails
+            glyphs.fill = " ";
+            glyphs.alt_fill = focus_fill;
+            glyphs.checkered = true;
+        } else {
+            // a focused block is drawn solid
+            glyphs.tl = glyphs.tr = glyphs.bl = glyphs.br = glyphs.hz = glyphs.vr
+                      = glyphs.fill = glyphs.alt_fill = highlight_fill;
+        }
+
+        glyph_table[type][true] = glyphs;
+    }
+
+    loaded = true;
+}
+
+// private
+BoxCache::box_rows BoxCache::build_rows(const glyph_set& glyphs, int width) const {
+    box_rows rows;
+
+    std::string horizontal = "";
+    for (int i = 0; i < width - 2; i++) horizontal += glyphs.hz;
+
+    rows.top = glyphs.tl + horizontal + glyphs.tr;
+    rows.bottom = glyphs.bl + horizontal + glyphs.br;
+
+    for (int parity = 0; parity < 2; parity++) {
+        std::string& line = rows.middle[parity];
+        line = glyphs.vr;
+
+        for (int j = 1; j < width - 1; j++) {
+            if (glyphs.checkered && (parity + j) % 2 == 0) line += glyphs.alt_fill;
+            else line += glyphs.fill;
+        }
+
+        line += glyphs.vr;
+    }
+
+    return rows;
+}
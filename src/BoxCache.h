@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Config.h"
+
+#include <string>
+#include <unordered_map>
+
+// ready made rows of the boxes drawn around blocks and days
+// the glyphs are read from the config once, rows are built once per width
+class BoxCache {
+public:
+    enum en_box_type { BOX_NORMAL, BOX_IMPORTANT, BOX_BACKGROUND };
+
+    struct box_rows {
+        std::string top;
+        std::string bottom;
+        std::string middle[2]; // interior rows, indexed by row parity (checkered fill)
+    };
+
+    BoxCache(Config* cfg_ptr);
+    BoxCache();
+
+    // rows for a box of this type and width, built on first use
+    const box_rows& get_rows(en_box_type type, bool filled, int width);
+    void clear(); // forget all rows and glyphs, they are reread from the config
+
+private:
+    Config* config_ptr;
+
+    struct glyph_set {
+        std::string tl, tr, bl, br, hz, vr;
+        std::string fill; // fill of the interior
+        std::string alt_fill; // every other cell of the interior, if checkered
+        bool checkered;
+    };
+
+    bool loaded; // whether glyph_table has been read from the config
+    glyph_set glyph_table[3][2]; // by type and filled
+
+    std::unordered_map<int, box_rows> row_cache[3][2]; // by type, filled, then width
+
+    void load_glyphs(); // read all glyphs from the config
+    box_rows build_rows(const glyph_set& glyphs, int width) const;
+};
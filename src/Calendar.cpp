@@ -0,0 +1,151 @@
+#include "Calendar.h"
+
+std::unordered_map<int, time_t> Calendar::midnight_cache = {};
+int Calendar::last_day = 0;
+time_t Calendar::last_day_start = 0;
+time_t Calendar::last_day_end = 0; // empty range, so the first lookup misses
+
+// public
+int Calendar::days_from_civil(int year, int month, int day) {
+    // eras of 400 years repeat exactly, years start in march so leap days come last
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int year_of_era = year - era * 400; // 0-399
+    const int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100
+                         + day_of_year; // 0-146096
+
+    return era * 146097 + day_of_era - 719468; // 719468 days from 0000-03-01 to 1970-01-01
+}
+
+// public
+Calendar::civil Calendar::civil_from_days(int day_num) {
+    day_num += 719468;
+    const int era = (day_num >= 0 ? day_num : day_num - 146096) / 146097;
+    const int day_of_era = day_num - era * 146097;
+    const int year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524
+                          - day_of_era / 146096) / 365;
+    const int day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4
+                          - year_of_era / 100);
+    const int month_index = (5 * day_of_year + 2) / 153; // 0 is march
+
+    civil date;
+    date.day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    date.month = month_index < 10 ? month_index + 3 : month_index - 9;
+    date.year = year_of_era + era * 400 + (date.month <= 2);
+
+    return date;
+}
+
+// public
+int Calendar::weekday(int day_num) {
+    return (day_num >= -4) ? (day_num + 4) % 7 : (day_num + 5) % 7 + 6; // 1970-01-01 was a thursday
+}
+
+// public
+int Calendar::days_in_month(int year, int month) {
+    if (month == 2) {
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        return leap ? 29 : 28;
+    }
+
+    return (month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31;
+}
+
+// public
+int Calendar::add_months(int day_num, int months) {
+    civil date = civil_from_days(day_num);
+
+    int month_index = date.year * 12 + (date.month - 1) + months;
+    int year = (month_index >= 0) ? month_index / 12 : (month_index - 11) / 12;
+    int month = month_index - year * 12 + 1;
+
+    int day = std::min(date.day, days_in_month(year, month));
+    return days_from_civil(year, month, day);
+}
+
+// public
+int Calendar::months_between(int from_day, int to_day) {
+    civil from = civil_from_days(from_day);
+    civil to = civil_from_days(to_day);
+
+    return (to.year - from.year) * 12 + (to.month - from.month);
+}
+
+// public
+int Calendar::day_of(time_t time) {
+    // most lookups are for the same day as the last one, which needs no time zone call
+    if (time >= last_day_start && time < last_day_end) return last_day;
+
+    struct tm local;
+    localtime_r(&time, &local);
+
+    last_day = day_of(local);
+    last_day_start = midnight(last_day);
+    last_day_end = midnight(last_day + 1);
+
+    return last_day;
+}
+
+// public
+int Calendar::day_of(const struct tm& time) {
+    return days_from_civil(time.tm_year + 1900, time.tm_mon + 1, time.tm_mday);
+}
+
+// public
+int Calendar::today() { return day_of(std::time(0)); }
+
+// public
+time_t Calendar::midnight(int day_num) {
+    auto it = midnight_cache.find(day_num);
+    if (it != midnight_cache.end()) return it->second;
+
+    struct tm local = to_tm(day_num);
+    time_t start = std::mktime(&local); // the one time zone lookup for this day
+
+    midnight_cache.emplace(day_num, start);
+    return start;
+}
+
+// public
+time_t Calendar::shift_days(time_t time, int days) {
+    // by the wall clock, the seconds since midnight differ on days the clocks change
+    struct tm local;
+    localtime_r(&time, &local);
+
+    local.tm_mday += days; // mktime carries it into the month and year
+    local.tm_isdst = -1;
+    return std::mktime(&local);
+}
+
+// public
+struct tm Calendar::to_tm(int day_num) {
+    civil date = civil_from_days(day_num);
+
+    struct tm local = {};
+    local.tm_year = date.year - 1900;
+    local.tm_mon = date.month - 1;
+    local.tm_mday = date.day;
+    local.tm_wday = weekday(day_num);
+    local.tm_yday = day_num - days_from_civil(date.year, 1, 1);
+    local.tm_isdst = -1; // let mktime work it out
+
+    return local;
+}
+
+// public
+bool Calendar::parse_date(const std::string& text, const std::string& format, int near_day,
+                          int& day_num) {
+    struct tm date = to_tm(near_day);
+
+    const char* end = strptime(text.c_str(), format.c_str(), &date);
+    if (end == nullptr || *end != '\0') return false;
+
+    day_num = days_from_civil(date.tm_year + 1900, date.tm_mon + 1, date.tm_mday);
+
+    bool has_year = format.find("%Y") != std::string::npos
+                 || format.find("%y") != std::string::npos;
+    if (!has_year && day_num < near_day) day_num = add_months(day_num, 12);
+
+    return true;
+}
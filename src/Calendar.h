@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ctime>
+#include <unordered_map>
+#include <algorithm>
+#include <string>
+
+// dates as civil day numbers (days since 1970-01-01, independent of the time zone)
+// so stepping between days is integer math, and the time zone is only asked once per day
+class Calendar {
+public:
+    struct civil {
+        int year;
+        int month; // 1-12
+        int day; // 1-31
+    };
+
+    static int days_from_civil(int year, int month, int day);
+    static civil civil_from_days(int day_num);
+
+    static int weekday(int day_num); // 0 is sunday, like tm_wday
+    static int days_in_month(int year, int month);
+    static int add_months(int day_num, int months); // the day of month is clamped to fit
+    static int months_between(int from_day, int to_day); // whole calendar months, ignores days
+
+    static int day_of(time_t time); // the local day a moment falls on
+    static int day_of(const struct tm& time); // same, from broken down local time
+    static int today();
+
+    static time_t midnight(int day_num); // local time the day starts (23 or 25h days on dst)
+    static time_t shift_days(time_t time, int days); // same wall clock time, days later
+    static struct tm to_tm(int day_num); // local midnight, broken down for strftime
+    // a date typed in this strptime format, what the format leaves out comes from near_day
+    // and a date without its year that already went by is meant for next year
+    // returns false if the text doesn't match the format
+    static bool parse_date(const std::string& text, const std::string& format, int near_day,
+                           int& day_num);
+
+private:
+    static std::unordered_map<int, time_t> midnight_cache;
+    static int last_day; // the day the last day_of call landed on
+    static time_t last_day_start, last_day_end; // and its bounds, for repeated lookups
+};
@@ -1,8 +1,48 @@
 #include "Config.h"
 
+// where the keybind of each command is, in the order of en_command
+static const std::string command_paths[Config::CMD_COUNT] = {
+    "keybinds.quit", "keybinds.left", "keybinds.up", "keybinds.down", "keybinds.right",
+    "keybinds.week.rename", "keybinds.week.new_block_below", "keybinds.week.new_block_above",
+    "keybinds.week.move_up", "keybinds.week.move_down",
+    "keybinds.week.move_right", "keybinds.week.move_left",
+    "keybinds.week.extend_top_up", "keybinds.week.extend_top_down",
+    "keybinds.week.extend_bottom_up", "keybinds.week.extend_bottom_down",
+    "keybinds.week.move_up_snap", "keybinds.week.move_down_snap",
+    "keybinds.week.extend_top_up_snap", "keybinds.week.extend_bottom_down_snap",
+    "keybinds.week.set_col_white", "keybinds.week.set_col_red",
+    "keybinds.week.set_col_green", "keybinds.week.set_col_yellow",
+    "keybinds.week.set_col_blue", "keybinds.week.set_col_purple",
+    "keybinds.week.set_col_aqua", "keybinds.week.set_col_gray",
+    "keybinds.week.toggle_important", "keybinds.week.toggle_collapsible",
+    "keybinds.week.edit_block_source", "keybinds.week.follow_link",
+    "keybinds.week.copy_left", "keybinds.week.copy_right",
+    "keybinds.week.copy_down", "keybinds.week.copy_up",
+    "keybinds.week.undo", "keybinds.week.redo",
+    "keybinds.week.remove", "keybinds.week.reload",
+    "keybinds.week.ripple_below", "keybinds.week.ripple_above",
+    "keybinds.week.ripple_remove", "keybinds.week.new_block_beside",
+    "keybinds.week.zoom_in", "keybinds.week.zoom_out", "keybinds.week.zoom_fit",
+    "keybinds.week.scroll_up", "keybinds.week.scroll_down",
+    "keybinds.week.scroll_left", "keybinds.week.scroll_right",
+    "keybinds.week.schedule", "keybinds.week.search", "keybinds.week.visual",
+    "keybinds.week.save_day_template", "keybinds.week.save_week_template",
+    "keybinds.week.apply_template", "keybinds.week.agenda",
+    "keybinds.week.go_to_date", "keybinds.week.next_free_slot",
+    "keybinds.week.prev_free_slot", "keybinds.week.next_important",
+    "keybinds.week.prev_important", "keybinds.week.next_same_color",
+    "keybinds.week.prev_same_color", "keybinds.week.next_same_title",
+    "keybinds.week.prev_same_title",
+    "keybinds.week.month_view", "keybinds.week.year_view",
+    "keybinds.week.confirm_rename", "keybinds.week.cancel_rename",
+    "keybinds.week.clear_rename",
+    "keybinds.search.next", "keybinds.search.prev",
+    "keybinds.overview.open_day", "keybinds.overview.close" };
+
 // public
 Config::Config(std::filesystem::path config_file) {
     error_str = "error in config file: " + config_file.string();
+    config_folder = config_file.parent_path();
 
     if (!std::filesystem::is_regular_file(config_file))
         throw std::runtime_error(error_str + ", file does not exist");
@@ -10,33 +50,245 @@ Config::Config(std::filesystem::path config_file) {
     try {
         toml_table = toml::parse_file(config_file.string());
     } catch (const toml::parse_error& err) {
-        std::cerr << error_str << ", error parsing:\n" << err << std::endl;
-        throw std::runtime_error("^");
+        // this can happen on a reload with the ui up, so the message goes into the error
+        std::ostringstream message;
+        message << err;
+        throw std::runtime_error(error_str + ", error parsing:\n" + message.str());
     }
+
+    compile();
+}
+
+// public
+std::filesystem::path Config::default_path() {
+    const char* xdg_config = std::getenv("XDG_CONFIG_HOME");
+    const char* home = std::getenv("HOME");
+
+    std::filesystem::path config_dir;
+    if (xdg_config != nullptr && xdg_config[0] != '\0') config_dir = xdg_config;
+    else if (home != nullptr) config_dir = std::filesystem::path(home) / ".config";
+    else throw std::runtime_error("can't find the config, neither XDG_CONFIG_HOME nor HOME is set");
+
+    return config_dir / "cadence" / "conf.toml";
 }
 
+// public
+int Config::update(const Config& fresh) {
+    int changed = 0;
+
+    if (day_start != fresh.day_start || day_end != fresh.day_end
+        || default_block_duration != fresh.default_block_duration) changed |= SEC_TIME;
+
+    if (target_day_width != fresh.target_day_width
+        || target_gap_width != fresh.target_gap_width) changed |= SEC_LAYOUT;
+
+    bool same_relative = std::equal(relative_names, relative_names + REL_COUNT,
+                                    fresh.relative_names);
+
+    if (date_format != fresh.date_format || day_format != fresh.day_format || !same_relative
+        || colors.background != fresh.colors.background || colors.today != fresh.colors.today
+        || colors.relative != fresh.colors.relative || colors.cursor != fresh.colors.cursor
+        || colors.link_http != fresh.colors.link_http
+        || colors.link_task != fresh.colors.link_task
+        || colors.link_file != fresh.colors.link_file) changed |= SEC_DAY_STYLE;
+
+    bool same_boxes = true;
+    for (int type = 0; type < 3; type++) {
+        const box_glyphs& a = boxes[type];
+        const box_glyphs& b = fresh.boxes[type];
+
+        same_boxes = same_boxes && a.tl == b.tl && a.tr == b.tr && a.bl == b.bl && a.br == b.br
+                                && a.hz == b.hz && a.vr == b.vr && a.fill == b.fill;
+    }
+
+    if (!same_boxes || highlight_fill != fresh.highlight_fill
+        || background_focus_fill != fresh.background_focus_fill) changed |= SEC_GLYPHS;
+
+    if (key_timeout != fresh.key_timeout
+        || !std::equal(keybinds, keybinds + CMD_COUNT, fresh.keybinds)) changed |= SEC_KEYS;
+
+    if (colors.status_normal != fresh.colors.status_normal
+        || colors.status_rename != fresh.colors.status_rename
+        || show_frame_bytes != fresh.show_frame_bytes) changed |= SEC_BAR;
+
+    if (save_path != fresh.save_path || hour_format != fresh.hour_format
+        || parse_format != fresh.parse_format) changed |= SEC_RESTART;
+
+    // the database was loaded with these, so they only change on a restart
+    std::filesystem::path kept_save_path = save_path;
+    std::string kept_hour_format = hour_format;
+    std::string kept_parse_format = parse_format;
+
+    *this = fresh;
+
+    save_path = kept_save_path;
+    hour_format = kept_hour_format;
+    parse_format = kept_parse_format;
+
+    return changed;
+}
 
 // public
 void Config::dump_info() {
     std::cout << toml_table << std::endl;
 }
 
+// private
+void Config::compile() {
+    save_path = get_str("save_path");
+
+    day_start = 60*60*get_num("time.day_start_hour", 0, 24)
+                 + 60*get_num("time.day_start_minute", 0, 59);
+    day_end = 60*60*get_num("time.day_end_hour", 0, 24)
+               + 60*get_num("time.day_end_minute", 0, 59);
+    default_block_duration = 60*get_num("time.default_block_minutes", 1, 24*60);
+
+    if (day_end > 24*60*60 || day_start >= day_end)
+        throw std::runtime_error(error_str + ", the day has to start before it ends");
+
+    target_day_width = get_num("ui.target_day_width", 1, 1000);
+    target_gap_width = get_num("ui.target_gap_width", 0, 1000);
+    show_frame_bytes = get_num("ui.show_frame_bytes", 0, 1, 0) != 0;
+
+    hour_format = get_str("ui.date_formats.hour_format");
+    parse_format = get_str("ui.date_formats.parse_format");
+    date_format = get_str("ui.date_formats.date_format");
+    day_format = get_str("ui.date_formats.day_format");
+
+    colors.background = get_num("ui.colors.background", 0, 255);
+    colors.today = get_num("ui.colors.today", 0, 255);
+    colors.relative = get_num("ui.colors.relative", 0, 255);
+    colors.cursor = get_num("ui.colors.cursor", -1, 255, -1);
+    if (colors.cursor == -1) colors.cursor = colors.today;
+    colors.link_http = get_num("ui.colors.link_http", 0, 255);
+    colors.link_task = get_num("ui.colors.link_task", 0, 255);
+    colors.link_file = get_num("ui.colors.link_file", 0, 255);
+    colors.status_normal = get_num("ui.colors.status_normal", 0, 255);
+    colors.status_rename = get_num("ui.colors.status_rename", 0, 255);
+
+    const std::string relative_ids[REL_COUNT] = {
+        "today", "yesterday", "tomorrow", "next_week", "last_week",
+        "next_month", "last_month", "next_year", "last_year" };
+
+    for (int i = 0; i < REL_COUNT; i++)
+        relative_names[i] = get_str("ui.relative_time." + relative_ids[i]);
+
+    highlight_fill = get_str("ui.boxdrawing.highlight_fill");
+    background_focus_fill = get_str("ui.boxdrawing.background_focus_fill");
+
+    const std::string box_ids[3] = { "normal", "important", "background" };
+
+    for (int type = 0; type < 3; type++) {
+        const std::string prefix = "ui.boxdrawing." + box_ids[type];
+
+        boxes[type].tl = get_str(prefix + "_tl");
+        boxes[type].tr = get_str(prefix + "_tr");
+        boxes[type].bl = get_str(prefix + "_bl");
+        boxes[type].br = get_str(prefix + "_br");
+        boxes[type].hz = get_str(prefix + "_hz");
+        boxes[type].vr = get_str(prefix + "_vr");
+        boxes[type].fill = get_str(prefix + "_fill");
+    }
+
+    key_timeout = get_num("keybinds.timeout", 0, 60*1000);
+
+    // commands added later have defaults, so older configs keep loading
+    std::string fallbacks[CMD_COUNT] = {};
+    fallbacks[CMD_RIPPLE_BELOW] = "go";
+    fallbacks[CMD_RIPPLE_ABOVE] = "gO";
+    fallbacks[CMD_RIPPLE_REMOVE] = "gd";
+    fallbacks[CMD_NEW_BLOCK_BESIDE] = "gb";
+    fallbacks[CMD_ZOOM_IN] = "+";
+    fallbacks[CMD_ZOOM_OUT] = "-";
+    fallbacks[CMD_ZOOM_FIT] = "=";
+    fallbacks[CMD_SCROLL_UP] = "<c-y>";
+    fallbacks[CMD_SCROLL_DOWN] = "<c-e>";
+    fallbacks[CMD_SCROLL_LEFT] = "<";
+    fallbacks[CMD_SCROLL_RIGHT] = ">";
+    fallbacks[CMD_SCHEDULE] = "gs";
+    fallbacks[CMD_SEARCH] = "/";
+    fallbacks[CMD_VISUAL] = "v";
+    fallbacks[CMD_SAVE_DAY_TEMPLATE] = "td";
+    fallbacks[CMD_SAVE_WEEK_TEMPLATE] = "tw";
+    fallbacks[CMD_APPLY_TEMPLATE] = "ta";
+    fallbacks[CMD_AGENDA] = "ga";
+    fallbacks[CMD_GO_TO_DATE] = "gt";
+    fallbacks[CMD_NEXT_FREE_SLOT] = "]f";
+    fallbacks[CMD_PREV_FREE_SLOT] = "[f";
+    fallbacks[CMD_NEXT_IMPORTANT] = "]i";
+    fallbacks[CMD_PREV_IMPORTANT] = "[i";
+    fallbacks[CMD_NEXT_SAME_COLOR] = "]c";
+    fallbacks[CMD_PREV_SAME_COLOR] = "[c";
+    fallbacks[CMD_NEXT_SAME_TITLE] = "]t";
+    fallbacks[CMD_PREV_SAME_TITLE] = "[t";
+    fallbacks[CMD_MONTH_VIEW] = "gm";
+    fallbacks[CMD_YEAR_VIEW] = "gy";
+    fallbacks[CMD_SEARCH_NEXT] = "<c-n>";
+    fallbacks[CMD_SEARCH_PREV] = "<c-p>";
+    fallbacks[CMD_OPEN_DAY] = "<cr>";
+    fallbacks[CMD_CLOSE_OVERVIEW] = "<esc>";
+
+    for (int i = 0; i < CMD_COUNT; i++) {
+        keybinds[i] = fallbacks[i].empty()? get_str(command_paths[i])
+                                          : get_str(command_paths[i], fallbacks[i]);
+
+        if (keybinds[i].empty())
+            throw std::runtime_error(error_str + ", empty keybind: " + command_paths[i]);
+    }
+
+    tasks_path = config_folder / get_str("schedule.tasks_file", "tasks.txt"); // absolute wins
+    schedule_days = get_num("schedule.days", 1, 366, 7);
+
+    templates_path = config_folder / get_str("templates.folder", "templates");
+}
+
 // public
-std::string Config::str(std::vector<std::string> keys) {
-    if (keys.empty()) return "";
+std::string Config::conflict_str(int command, int other) const {
+    return error_str + ", " + command_paths[other] + " and " + command_paths[command]
+         + " are both bound to " + keybinds[command];
+}
 
-    toml::node_view current_node = toml_table[keys[0]];
-    for (size_t i = 1; i < keys.size(); i++) current_node = current_node[keys[i]];
+// private
+template <typename T>
+std::optional<T> Config::find(const std::string& path) {
+    size_t dot = path.find('.');
+    toml::node_view current_node = toml_table[path.substr(0, dot)];
 
-    return current_node.value_or("");
+    while (dot != std::string::npos) {
+        size_t next = path.find('.', dot + 1);
+        current_node = current_node[path.substr(dot + 1, next - dot - 1)];
+        dot = next;
+    }
+
+    return current_node.template value<T>();
 }
 
-//public
-int Config::num(std::vector<std::string> keys) {
-    if (keys.empty()) return 0;
+// private
+std::string Config::get_str(const std::string& path) {
+    std::optional<std::string> value = find<std::string>(path);
 
-    toml::node_view current_node = toml_table[keys[0]];
-    for (size_t i = 1; i < keys.size(); i++) current_node = current_node[keys[i]];
+    if (!value) throw std::runtime_error(error_str + ", missing string: " + path);
+    return *value;
+}
+
+// private
+std::string Config::get_str(const std::string& path, const std::string& fallback) {
+    return find<std::string>(path).value_or(fallback);
+}
+
+// private
+int Config::get_num(const std::string& path, int min, int max) {
+    std::optional<int64_t> value = find<int64_t>(path);
+
+    if (!value) throw std::runtime_error(error_str + ", missing number: " + path);
+    if (*value < min || *value > max) throw std::runtime_error(error_str + ", " + path
+        + " has to be between " + std::to_string(min) + " and " + std::to_string(max));
+
+    return *value;
+}
 
-    return current_node.value_or(0);
+// private
+int Config::get_num(const std::string& path, int min, int max, int fallback) {
+    if (!find<int64_t>(path)) return fallback;
+    return get_num(path, min, max);
 }
@@ -4,19 +4,120 @@
 // #include "../lib/toml.hpp"
 #include <toml++/toml.hpp>
 #include <filesystem>
+#include <optional>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
 
+// the settings from the toml file, resolved into typed fields and checked once at load
+// (nothing reads the toml table after the constructor)
 class Config {
 public:
     Config(std::filesystem::path config_file); // loads config from toml file
-    
-    std::string str(std::vector<std::string> keys);
-    int num(std::vector<std::string> keys);
-    
+
+    // $XDG_CONFIG_HOME/cadence/conf.toml, or ~/.config/cadence/conf.toml
+    static std::filesystem::path default_path();
+
+    // what a reload changed, so only the caches depending on it are dropped
+    enum en_section {
+        SEC_TIME      = 1 << 0, // day bounds and default block length
+        SEC_LAYOUT    = 1 << 1, // target widths
+        SEC_DAY_STYLE = 1 << 2, // date formats, colors and relative day names
+        SEC_GLYPHS    = 1 << 3, // box drawing
+        SEC_KEYS      = 1 << 4, // keybinds and their timeout
+        SEC_BAR       = 1 << 5, // bottom bar colors and stats
+        SEC_RESTART   = 1 << 6  // save path and block formats, only read at startup
+    };
+
+    // take over everything from a freshly loaded config except the SEC_RESTART fields
+    // (the database and its blocks keep using those), returns the sections that changed
+    int update(const Config& fresh);
+
+    // every command a key sequence can be bound to, in the order they are matched
+    enum en_command {
+        CMD_QUIT, CMD_LEFT, CMD_UP, CMD_DOWN, CMD_RIGHT,
+        CMD_RENAME, CMD_NEW_BLOCK_BELOW, CMD_NEW_BLOCK_ABOVE,
+        CMD_MOVE_UP, CMD_MOVE_DOWN, CMD_MOVE_RIGHT, CMD_MOVE_LEFT,
+        CMD_EXTEND_TOP_UP, CMD_EXTEND_TOP_DOWN, CMD_EXTEND_BOTTOM_UP, CMD_EXTEND_BOTTOM_DOWN,
+        CMD_MOVE_UP_SNAP, CMD_MOVE_DOWN_SNAP, CMD_EXTEND_TOP_UP_SNAP, CMD_EXTEND_BOTTOM_DOWN_SNAP,
+        CMD_SET_COL_WHITE, CMD_SET_COL_RED, CMD_SET_COL_GREEN, CMD_SET_COL_YELLOW,
+        CMD_SET_COL_BLUE, CMD_SET_COL_PURPLE, CMD_SET_COL_AQUA, CMD_SET_COL_GRAY,
+        CMD_TOGGLE_IMPORTANT, CMD_TOGGLE_COLLAPSIBLE, CMD_EDIT_BLOCK_SOURCE, CMD_FOLLOW_LINK,
+        CMD_COPY_LEFT, CMD_COPY_RIGHT, CMD_COPY_DOWN, CMD_COPY_UP,
+        CMD_UNDO, CMD_REDO, CMD_REMOVE, CMD_RELOAD,
+        CMD_RIPPLE_BELOW, CMD_RIPPLE_ABOVE, CMD_RIPPLE_REMOVE, CMD_NEW_BLOCK_BESIDE,
+        CMD_ZOOM_IN, CMD_ZOOM_OUT, CMD_ZOOM_FIT,
+        CMD_SCROLL_UP, CMD_SCROLL_DOWN, CMD_SCROLL_LEFT, CMD_SCROLL_RIGHT,
+        CMD_SCHEDULE, CMD_SEARCH, CMD_VISUAL,
+        CMD_SAVE_DAY_TEMPLATE, CMD_SAVE_WEEK_TEMPLATE, CMD_APPLY_TEMPLATE, CMD_AGENDA,
+        CMD_GO_TO_DATE, CMD_NEXT_FREE_SLOT, CMD_PREV_FREE_SLOT, // the count is the minutes
+        CMD_NEXT_IMPORTANT, CMD_PREV_IMPORTANT, CMD_NEXT_SAME_COLOR, CMD_PREV_SAME_COLOR,
+        CMD_NEXT_SAME_TITLE, CMD_PREV_SAME_TITLE,
+        CMD_MONTH_VIEW, CMD_YEAR_VIEW, // also switch between them in the overview
+        CMD_CONFIRM_RENAME, CMD_CANCEL_RENAME, CMD_CLEAR_RENAME, // used while typing text
+        CMD_SEARCH_NEXT, CMD_SEARCH_PREV, // only used in the search prompt
+        CMD_OPEN_DAY, CMD_CLOSE_OVERVIEW, // only used in the overview
+        CMD_COUNT,
+        CMD_NONE = CMD_COUNT // no command matched
+    };
+    static const en_command CMD_LAST_WEEK = CMD_YEAR_VIEW; // the last command of week mode
+
+    enum en_relative { REL_TODAY, REL_YESTERDAY, REL_TOMORROW, REL_NEXT_WEEK, REL_LAST_WEEK,
+                       REL_NEXT_MONTH, REL_LAST_MONTH, REL_NEXT_YEAR, REL_LAST_YEAR, REL_COUNT };
+
+    struct box_glyphs { std::string tl, tr, bl, br, hz, vr, fill; };
+
+    struct color_table { // color pairs
+        int background, today, relative;
+        int cursor; // already falls back to today if unset
+        int link_http, link_task, link_file;
+        int status_normal, status_rename;
+    };
+
+    std::filesystem::path save_path;
+
+    time_t day_start, day_end; // seconds after midnight
+    time_t default_block_duration; // seconds
+
+    int target_day_width, target_gap_width;
+    bool show_frame_bytes;
+
+    std::string hour_format, parse_format, date_format, day_format;
+    color_table colors;
+    std::string relative_names[REL_COUNT];
+
+    std::string highlight_fill, background_focus_fill;
+    box_glyphs boxes[3]; // normal, important and background (same order as BoxCache)
+
+    // ms until an unfinished key sequence is dropped, or one that is a whole binding
+    // (that longer ones start with) runs
+    int key_timeout;
+    std::string keybinds[CMD_COUNT];
+    // the error for two commands of one mode bound to the same keys, naming both keybinds
+    std::string conflict_str(int command, int other) const;
+
+    std::filesystem::path tasks_path; // the unscheduled tasks, one per line (see Scheduler)
+    int schedule_days; // how many days from the focused one tasks are spread over
+
+    std::filesystem::path templates_path; // the folder day and week templates are saved in
+
     void dump_info();
 private:
     toml::table toml_table;
     std::string error_str;
+    std::filesystem::path config_folder; // relative paths in the config start here
+
+    void compile(); // fill in every field above from toml_table, throws if one is invalid
+
+    template <typename T>
+    std::optional<T> find(const std::string& path); // dotted path, empty if missing
+
+    std::string get_str(const std::string& path); // throws if missing
+    std::string get_str(const std::string& path, const std::string& fallback); // optional key
+    int get_num(const std::string& path, int min, int max); // throws if missing or out of range
+    int get_num(const std::string& path, int min, int max, int fallback); // optional key
 };
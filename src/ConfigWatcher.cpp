@@ -0,0 +1,103 @@
+#include "ConfigWatcher.h"
+
+ConfigWatcher::ConfigWatcher(std::filesystem::path config_file_) {
+    config_file = config_file_;
+    parsing = false;
+    parse_again = false;
+    has_result = false;
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    ready_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotify_fd < 0 || ready_fd < 0)
+        throw std::runtime_error("unable to watch config file: " + config_file.string());
+
+    // editors often save by renaming a new file over the old one, so watch the folder
+    std::string folder = config_file.parent_path().string();
+    if (inotify_add_watch(inotify_fd, folder.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+        throw std::runtime_error("unable to watch config folder: " + folder);
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    if (worker.joinable()) worker.join();
+
+    close(inotify_fd);
+    close(ready_fd);
+}
+
+// public
+void ConfigWatcher::handle_changes() {
+    alignas(struct inotify_event) char buffer[4096];
+    bool touched = false;
+    ssize_t length;
+
+    while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + length; ) {
+            const struct inotify_event* event = (const struct inotify_event*) ptr;
+
+            if (event->len > 0 && config_file.filename() == event->name) touched = true;
+
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    if (touched) start_parse();
+}
+
+// public
+bool ConfigWatcher::take_result(std::unique_ptr<Config>& config, std::string& error) {
+    uint64_t count;
+    read(ready_fd, &count, sizeof(count));
+
+    std::lock_guard<std::mutex> lock(result_mutex);
+    if (!has_result) return false;
+
+    config = std::move(result);
+    error = result_error;
+    has_result = false;
+
+    // the file was written again while it was being parsed
+    if (parse_again && !parsing) {
+        parse_again = false;
+        start_parse();
+    }
+
+    return true;
+}
+
+// private
+void ConfigWatcher::start_parse() {
+    if (parsing) {
+        parse_again = true; // picked up in take_result
+        return;
+    }
+
+    if (worker.joinable()) worker.join();
+
+    parsing = true;
+    worker = std::thread([this]() { parse(); });
+}
+
+// private
+void ConfigWatcher::parse() {
+    std::unique_ptr<Config> fresh;
+    std::string error = "";
+
+    try {
+        fresh = std::make_unique<Config>(config_file);
+    } catch (const std::exception& err) {
+        error = err.what();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(result_mutex);
+        result = std::move(fresh);
+        result_error = error;
+        has_result = true;
+    }
+
+    parsing = false;
+
+    uint64_t one = 1;
+    write(ready_fd, &one, sizeof(one));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Config.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+
+// watches the config file and parses it again on a background thread when it changes
+// the ui thread gets the result thru take_result once get_ready_fd is readable
+class ConfigWatcher {
+public:
+    ConfigWatcher(std::filesystem::path config_file_);
+    ~ConfigWatcher();
+
+    int get_change_fd() const { return inotify_fd; } // readable when the folder changed
+    int get_ready_fd() const { return ready_fd; } // readable when a parse finished
+
+    void handle_changes(); // ui thread, starts a parse if the file was written
+    // ui thread, returns false if nothing is waiting
+    // on success config is set, on failure error is
+    bool take_result(std::unique_ptr<Config>& config, std::string& error);
+
+private:
+    std::filesystem::path config_file;
+    int inotify_fd;
+    int ready_fd; // eventfd, bumped when a parse finished
+
+    std::thread worker;
+    std::atomic<bool> parsing; // whether the worker is still running
+    bool parse_again; // the file changed during the last parse
+
+    std::mutex result_mutex;
+    std::unique_ptr<Config> result; // guarded by result_mutex
+    std::string result_error;
+    bool has_result;
+
+    void start_parse();
+    void parse(); // worker thread body
+};
@@ -1,9 +1,13 @@
 #include "Database.h"
 
-Database::Database(Config* cfg_ptr) {
+Database::Database(Config* cfg_ptr) : rng(std::random_device()()) {
     config_ptr = cfg_ptr;
+    current_batch = 0;
+    batch_count = 0;
+    transaction_depth = 0;
+    gap_day_start = gap_day_end = -1; // measured on the first search
 
-    source_folder = config_ptr->str({"save_path"});
+    source_folder = config_ptr->save_path;
     error_str = "database in folder " + source_folder.string();
     source_folder_integrity(source_folder);
 
@@ -11,543 +15,1007 @@ Database::Database(Config* cfg_ptr) {
         : std::filesystem::directory_iterator(source_folder)) {
         if (!std::filesystem::is_regular_file(file)) continue;
 
-        insert_block(Block(file, config_ptr));
+        put_file_block(Block(file, config_ptr));
     }
 }
 
 // public
-std::vector<Block> Database::get_blocks_on_day(struct tm date) const {
-    time_t start_time = std::mktime(&date);
-    time_t end_time = start_time + 24*60*60;
+std::vector<Block> Database::get_blocks_on_day(int day) {
+    expand_series(day, day);
+
+    time_t start_time = Calendar::midnight(day);
+    time_t end_time = Calendar::midnight(day + 1); // not always 24h later
 
     std::vector<Block> ret;
 
-    bool hit_start = false;
-    for (size_t i = 0; i < block_list.size(); i++) {
-        Block block = block_list[i];
+    // the list is sorted, so the day starts at the first block not before midnight
+    auto it = std::lower_bound(block_list.begin(), block_list.end(), start_time,
+        [](const Block& block, time_t t) { return block.get_time_t_start() < t; });
+
+    for (; it != block_list.end() && it->get_time_t_start() < end_time; it++)
+        ret.push_back(*it);
+
+    return ret;
+}
 
-        if (!hit_start && block.get_time_t_start() >= start_time) hit_start = true;
+// public
+std::vector<Block> Database::get_blocks_between(time_t first, time_t last) {
+    std::vector<Block> ret;
+    if (first > last) return ret;
 
-        if (hit_start) {
-            if (block.get_time_t_start() >= end_time) return ret;
-            ret.push_back(block);
+    expand_series(Calendar::day_of(first), Calendar::day_of(last));
+
+    auto it = std::lower_bound(block_list.begin(), block_list.end(), first,
+        [](const Block& block, time_t t) { return block.get_time_t_start() < t; });
+
+    for (; it != block_list.end() && it->get_time_t_start() <= last; it++)
+        ret.push_back(*it);
+
+    return ret;
+}
+
+// public
+std::vector<Block> Database::get_blocks_after(block_key key, size_t count) {
+    std::vector<Block> ret;
+    int day = Calendar::day_of(key.start);
+    int empty_days = 0;
+
+    while (ret.size() < count && empty_days < 366) {
+        expand_series(day, day + RANGE_CHUNK_DAYS - 1);
+        time_t chunk_end = Calendar::midnight(day + RANGE_CHUNK_DAYS);
+
+        // found again in every chunk, expanding inserts into the list
+        size_t idx = index_after(key), found = ret.size();
+        for (; idx < block_list.size() && ret.size() < count; idx++) {
+            if (block_list[idx].get_time_t_start() >= chunk_end) break;
+            ret.push_back(block_list[idx]);
+        }
+
+        if (idx == block_list.size() && series_map.empty()) break; // nothing further on
+        empty_days = (ret.size() == found)? empty_days + RANGE_CHUNK_DAYS : 0;
+
+        if (!ret.empty()) key = { ret.back().get_time_t_start(), ret.back().get_track() };
+        day += RANGE_CHUNK_DAYS;
+    }
+
+    return ret;
+}
+
+// public
+std::vector<Block> Database::get_blocks_before(block_key key, size_t count) {
+    std::vector<Block> ret;
+    int day = Calendar::day_of(key.start);
+    int empty_days = 0;
+
+    // a series starts on its first occurrence, so none are before the earliest one
+    int first_series_day = std::numeric_limits<int>::max();
+    for (const auto& [id, series] : series_map)
+        first_series_day = std::min(first_series_day, series.get_day());
+
+    while (ret.size() < count && empty_days < 366) {
+        expand_series(day - RANGE_CHUNK_DAYS + 1, day);
+        time_t chunk_start = Calendar::midnight(day - RANGE_CHUNK_DAYS + 1);
+
+        // the blocks before the first one not before the key
+        size_t idx = index_after({ key.start, key.track - 1 }), found = ret.size();
+        for (; idx > 0 && ret.size() < count; idx--) {
+            if (block_list[idx - 1].get_time_t_start() < chunk_start) break;
+            ret.push_back(block_list[idx - 1]);
         }
+
+        if (idx == 0 && day - RANGE_CHUNK_DAYS < first_series_day) break; // nothing earlier
+        empty_days = (ret.size() == found)? empty_days + RANGE_CHUNK_DAYS : 0;
+
+        if (!ret.empty()) key = { ret.back().get_time_t_start(), ret.back().get_track() };
+        day -= RANGE_CHUNK_DAYS;
     }
 
     return ret;
 }
 
 // private
-size_t Database::index_at_time(time_t block_time) {
-    return index_at_time_impl(block_time, 0, block_list.size()-1);
+size_t Database::index_after(const block_key& key) const {
+    auto it = std::upper_bound(block_list.begin(), block_list.end(), key,
+        [](const block_key& k, const Block& block) {
+            time_t start = block.get_time_t_start();
+            return (k.start != start)? k.start < start : k.track < block.get_track();
+        });
+
+    return it - block_list.begin();
 }
 
 // private
-size_t Database::index_at_time_impl(time_t block_time, size_t range_start, size_t range_end) {
-    // recursive binary search
-    if (range_start == range_end) throw std::runtime_error (error_str
-         + ", error searching for block with start time: " + std::to_string(block_time)
-         + ", range collapsed down to index: " + std::to_string(range_start));
+size_t Database::index_at_time(time_t block_time, int track) {
+    auto it = std::lower_bound(block_list.begin(), block_list.end(), block_time,
+        [](const Block& block, time_t t) { return block.get_time_t_start() < t; });
 
-    if (block_list[range_start].get_time_t_start() == block_time) return range_start;
-    if (block_list[range_end].get_time_t_start() == block_time) return range_end;
+    // the blocks starting then are next to each other, in the order of their tracks
+    for (; it != block_list.end() && it->get_time_t_start() == block_time; it++)
+        if (it->get_track() == track) return it - block_list.begin();
 
-    size_t pivot = (range_start + range_end) / 2;
-    time_t pivot_time = block_list[pivot].get_time_t_start();
+    throw std::runtime_error(error_str + ", no block with start time "
+        + std::to_string(block_time) + " on track " + std::to_string(track));
+}
 
-    if (block_time == pivot_time) return pivot;
-    else if (block_time < pivot_time) return index_at_time_impl(block_time, range_start, pivot);
-    else if (block_time > pivot_time) return index_at_time_impl(block_time, pivot, range_end);
-    else return 0; // never hits
+// private
+bool Database::sorts_before(const Block& l, const Block& r) {
+    time_t l_start = l.get_time_t_start(), r_start = r.get_time_t_start();
+    return (l_start != r_start)? l_start < r_start : l.get_track() < r.get_track();
 }
 
 // public
-void Database::rename_block(time_t block_time, std::string new_title) {
-    int idx = index_at_time(block_time);
+void Database::rename_block(time_t block_time, int track, std::string new_title) {
+    begin_transaction(); // with taking an occurrence out of its series
+    int idx = own_block(index_at_time(block_time, track));
 
     Block old_block = block_list[idx];
 
+    add_to_summary(block_list[idx], -1); // the title index has it
     block_list[idx].set_title(new_title);
+    add_to_summary(block_list[idx], 1);
     block_list[idx].save_to_file();
 
     old_block.set_title(old_block.get_title());
 
-    undo_vec.push_back({ ACT_MODIFY, idx, old_block });
+    push_undo({ ACT_MODIFY, idx, old_block });
+    end_transaction();
 }
 
 // private
 int Database::fresh_id() {
-    std::random_device dev;
-    std::mt19937 rng(dev());
-    std::uniform_int_distribution<std::mt19937::result_type> id_range(1,99999);
+    std::uniform_int_distribution<int> id_range(1, 99999);
 
     int ret = id_range(rng);
-
-    for (Block block : block_list) {
-        if (block.get_id() == ret)
-            return fresh_id(); // try again
-    }
-
-    // if we got here, ret was never equal to a block's id
-    // or else we would have hit the other return
+    while (id_set.count(ret) != 0) ret = id_range(rng); // taken, try again
 
     return ret;
 }
 
-// private
-int Database::index_before_time(time_t block_time) {
-    for (size_t i = block_list.size()-1; i >= 0; i--) {
-        if (block_list[i].get_time_t_start() < block_time) return i;
-    }
-
-    return -1;
-}
-
-// private
-int Database::index_after_time(time_t block_time) {
-    for (size_t i = 0; i < block_list.size(); i++) {
-        if (block_list[i].get_time_t_end() > block_time) return i;
-    }
-
-    return -1;
-}
-
 // public
 // precondition: time is the end time of a valid block, or day start if the day is empty
-bool Database::new_block_below(time_t block_time) {
+bool Database::new_block_below(time_t block_time, int track) {
     // need to find the next block after this time
     Block block(config_ptr, fresh_id());
     block.set_time_t_start(block_time);
-    block.set_duration(60*config_ptr->num({"time", "default_block_minutes"}));
-
-    int next_idx = index_after_time(block_time);
-    time_t this_day_end = block.get_date_time()
-                        + 60*60*config_ptr->num({"time", "day_end_hour"})
-                        + 60*config_ptr->num({"time", "day_end_minute"});
-
-    if (next_idx == -1 || block_list[next_idx].get_time_t_start() >= block.get_time_t_end()) {
-        // then the next block is not in the way
-        // just check that we are not hitting day end
-        if (block.get_time_t_start() >= this_day_end) {
-            return false; // refuse to move previous task
-        } else if (block.get_time_t_end() > this_day_end) {
-            // just shorten block until it fits in the day
-            block.set_duration(this_day_end - block.get_time_t_start());
-        } else {
-            // both times are before day_end
-            // nothing can be before day_start bc this is ..._below()
-            // all is good
-        }
-    } else if (block_list[next_idx].get_time_t_start() <= block.get_time_t_start()) {
-        // this block is trying to start inside the next one, can't modify other blocks
-        return false;
-    } else if (block_list[next_idx].get_time_t_start() <= block.get_time_t_end()) {
-        // this block ends inside the next block, shorten it
-        block.set_duration(block_list[next_idx].get_time_t_start()
-                           - block.get_time_t_start());
-    } else {
-        return false;
-    }
+    block.set_duration(config_ptr->default_block_duration);
+    block.set_track(track);
+
+    time_t this_day_end = block.get_date_time() + config_ptr->day_end;
+
+    // it is shortened to the room before the next block or the end of the day
+    time_t room = occupancy[track].free_after(block_time, this_day_end);
+    if (room <= 0) return false; // starts inside a block, can't modify other blocks
+
+    block.set_duration(std::min(block.get_duration(), room));
 
     block.save_to_file();
     int idx = insert_block(block);
 
-    undo_vec.push_back({ ACT_CREATE, idx, block });
+    push_undo({ ACT_CREATE, idx, block });
 
     return true;
 }
 
 // public
 // precondition: time is the start time of a valid block
-bool Database::new_block_above(time_t block_time) {
+bool Database::new_block_above(time_t block_time, int track) {
     // create a block that exists exactly where we would put it if there was space
     Block block(config_ptr, fresh_id());
-    block.set_duration(60*config_ptr->num({"time", "default_block_minutes"}));
+    block.set_duration(config_ptr->default_block_duration);
     block.set_time_t_start(block_time - block.get_duration());
+    block.set_track(track);
 
-    int prev_idx = index_before_time(block_time);
-    time_t this_day_start = block.get_date_time();
-
-    if (prev_idx == -1 || block_list[prev_idx].get_time_t_end() <= block.get_time_t_start()) {
-        // either there is no prev block, or it is not in the way
-
-        // just check that we are not hitting day start
-        if (block.get_time_t_end() <= this_day_start) {
-            return false; // we are fully out of the day, and can't modify anything else
-        } else if (block.get_time_t_start() < this_day_start) {
-            // just shorten block until it fits in the day
-            block.set_duration(block.get_time_t_end() - this_day_start);
-            block.set_time_t_start(this_day_start);
-        } else {
-            // we are not hitting any blocks
-            // and are fully clear of day boundaries
-            // all is good, proceed
-        }
-    } else if (block.get_time_t_end() <= block_list[prev_idx].get_time_t_end()) {
-        // this block is fully colliding with prev block, can't do anything
-        return false;
-    } else if (block.get_time_t_start() <= block_list[prev_idx].get_time_t_end()) {
-        // this block starts inside the prev block, shorten it
-        block.set_duration(block.get_time_t_end()
-                           - block_list[prev_idx].get_time_t_end());
-        block.set_time_t_start(block_list[prev_idx].get_time_t_end());
-    } else {
-        return false;
-    }
+    time_t this_day_start = Calendar::midnight(Calendar::day_of(block_time))
+                          + config_ptr->day_start;
+
+    // it is shortened to the room after the previous block or the start of the day
+    time_t room = occupancy[track].free_before(block_time, this_day_start);
+    if (room <= 0) return false; // fully colliding with the previous block
+
+    block.set_duration(std::min(block.get_duration(), room));
+    block.set_time_t_start(block_time - block.get_duration());
 
     // if we've gotten here, we have succesfully fit the new block in, now save it
     block.save_to_file();
     int idx = insert_block(block);
 
-    undo_vec.push_back({ ACT_CREATE, idx, block });
+    push_undo({ ACT_CREATE, idx, block });
 
     return true;
 }
 
 // public
-bool Database::move_block_up(time_t block_time) {
-    if (extend_top_up(block_time)) {
-        extend_bottom_up(block_time-60);
-        return true;
+int Database::new_block_beside(time_t block_time, int track) {
+    time_t end = block_list[index_at_time(block_time, track)].get_time_t_end();
+
+    for (int other = 0; other < Block::TRACK_COUNT; other++) {
+        // the block's own track has no room here, so it is skipped as well
+        time_t room = occupancy[other].free_after(block_time, end);
+        if (room <= 0) continue;
+
+        Block block(config_ptr, fresh_id());
+        block.set_time_t_start(block_time);
+        block.set_duration(room);
+        block.set_track(other);
+        block.save_to_file();
+
+        push_undo({ ACT_CREATE, int(insert_block(block)), block });
+        return other;
     }
 
-    return false;
+    return -1;
 }
 
 // public
-bool Database::move_block_down(time_t block_time) {
-    if (extend_bottom_down(block_time)) {
-        extend_top_down(block_time);
-        return true;
-    }
+int Database::move_block_up(time_t block_time, int track, int minutes) {
+    size_t idx = index_at_time(block_time, track);
 
-    return false;
+    int amt = std::min(minutes, minutes_free_above(idx));
+    if (amt <= 0) return 0;
+
+    shift_block_edges(idx, -60*amt, -60*amt);
+    return amt;
 }
 
 // public
-bool Database::move_block_lateral(time_t block_time, int amt) {
-    size_t idx_this = index_at_time(block_time);
+int Database::move_block_down(time_t block_time, int track, int minutes) {
+    size_t idx = index_at_time(block_time, track);
+
+    int amt = std::min(minutes, minutes_free_below(idx));
+    if (amt <= 0) return 0;
+
+    shift_block_edges(idx, 60*amt, 60*amt);
+    return amt;
+}
+
+// public
+bool Database::move_block_lateral(time_t block_time, int track, int amt) {
+    time_t target_block_time = Calendar::shift_days(block_time, amt);
+    expand_series(Calendar::day_of(target_block_time), Calendar::day_of(target_block_time));
+
+    // the target is on another day, so the block itself can't be in the way
+    size_t idx_this = index_at_time(block_time, track);
+    time_t target_end = target_block_time + block_list[idx_this].get_duration();
+    if (!occupancy[track].is_free(target_block_time, target_end)) return false;
+
+    begin_transaction();
+    idx_this = own_block(idx_this);
+
     Block block = block_list[idx_this];
-    block_list.erase(block_list.begin() + idx_this); // the index might change, so we will
-                                                     // remove and put back in later
+    erase_block(idx_this); // the index might change, so we will
+                           // remove and put back in later
 
-    time_t target_block_time = block_time + amt * 24*60*60;
+    block.set_time_t_start(block.get_time_t_start()); // flag as modified
+    action act = { ACT_MODIFY, -1, block }; // save the old block into action
+                                            // NOTE: -1 will be overwritten
 
-    size_t idx_before = index_before_time(target_block_time);
-    size_t idx_after = index_after_time(target_block_time + block.get_duration());
+    block.set_time_t_start(target_block_time);
+    block.save_to_file();
 
-    if (idx_before == -1 || block_list[idx_before].get_time_t_end()
-                            <= target_block_time) {
+    act.index = insert_block(block);
 
-        if (idx_after == -1 || block_list[idx_after].get_time_t_start()
-                               >= target_block_time + block.get_duration()) {
+    push_undo(act);
+    end_transaction();
 
-            block.set_time_t_start(block.get_time_t_start()); // flag as modified
-            action act = { ACT_MODIFY, -1, block }; // save the old block into action
-                                                    // NOTE: -1 will be overwritten
+    return true;
+}
 
-            block.set_time_t_start(target_block_time);
-            block.save_to_file();
 
-            act.index = insert_block(block);
+// public
+int Database::extend_top_up(time_t block_time, int track, int minutes) {
+    size_t idx = index_at_time(block_time, track);
 
-            undo_vec.push_back(act);
+    int amt = std::min(minutes, minutes_free_above(idx));
+    if (amt <= 0) return 0;
 
-            return true;
-        }
-    }
+    shift_block_edges(idx, -60*amt, 0);
+    return amt;
+}
 
-    // the condition failed, block is not moved
-    // so we have to reinsert the block into the vector
-    insert_block(block);
+// public
+int Database::extend_top_down(time_t block_time, int track, int minutes) {
+    size_t idx = index_at_time(block_time, track);
 
-    return false;
+    int amt = std::min(minutes, minutes_shrinkable(idx));
+    if (amt <= 0) return 0;
+
+    shift_block_edges(idx, 60*amt, 0);
+    return amt;
 }
 
+// public
+int Database::extend_bottom_up(time_t block_time, int track, int minutes) {
+    size_t idx = index_at_time(block_time, track);
+
+    int amt = std::min(minutes, minutes_shrinkable(idx));
+    if (amt <= 0) return 0;
+
+    shift_block_edges(idx, 0, -60*amt);
+    return amt;
+}
 
 // public
-bool Database::extend_top_up(time_t block_time) {
-    int idx = index_at_time(block_time);
-    Block& block = block_list[idx]; // not a ref or pointer
+int Database::extend_bottom_down(time_t block_time, int track, int minutes) {
+    size_t idx = index_at_time(block_time, track);
 
-    time_t prev_block_end = block.get_date_time()
-                          + 60*60*config_ptr->num({"time", "day_start_hour"})
-                          + 60*config_ptr->num({"time", "day_start_minute"});
+    int amt = std::min(minutes, minutes_free_below(idx));
+    if (amt <= 0) return 0;
 
-    if (idx != 0) {
-        prev_block_end = std::max(prev_block_end, block_list[idx-1].get_time_t_end());
-    }
+    shift_block_edges(idx, 0, 60*amt);
+    return amt;
+}
 
-    if (block_time <= prev_block_end) return false;
-    else {
-        block.set_time_t_start(block.get_time_t_start());
-        block.set_duration(block.get_duration());
+// private
+int Database::minutes_free_above(size_t idx) {
+    const Block& block = block_list[idx];
+    time_t this_day_start = block.get_date_time() + config_ptr->day_start;
 
-        // check last save, if it was this block moving, we don't make a history save
-        if (undo_vec.empty()) {
-            undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
-        } else {
-            action last_act = undo_vec.back();
-            Block last_block = last_act.block;
+    time_t space = occupancy[block.get_track()].free_before(block.get_time_t_start(),
+                                                           this_day_start);
+    return (space + 59) / 60; // one minute steps until it touches
+}
 
-            if (last_act.type == ACT_MODIFY
-                && last_act.index == idx
-                && last_block.get_id() == block.get_id()
-                && last_block.get_title() == block.get_title()
-                && last_block.get_collapsible() == block.get_collapsible()
-                && last_block.get_important() == block.get_important()
-                && last_block.get_date_time() == block.get_date_time()
-                && last_block.get_color() == block.get_color()
-            ) {
-                // last action was also a move of this block, so lets make another save
-            } else {
-                undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
-            }
-        }
+// private
+int Database::minutes_free_below(size_t idx) {
+    const Block& block = block_list[idx];
+    time_t this_day_end = block.get_date_time() + config_ptr->day_end;
 
-        block.set_time_t_start(block.get_time_t_start() - 60);
-        block.set_duration(block.get_duration() + 60);
+    time_t space = occupancy[block.get_track()].free_after(block.get_time_t_end(),
+                                                          this_day_end);
+    return (space + 59) / 60;
+}
 
-        block.save_to_file();
+// private
+int Database::minutes_shrinkable(size_t idx) {
+    time_t duration = block_list[idx].get_duration();
+    return (duration <= 60)? 0 : (duration - 1) / 60; // never shorter than a minute
+}
 
-        return true;
+// private
+bool Database::fits_in_day(time_t start, time_t end) const {
+    time_t date_time = Calendar::midnight(Calendar::day_of(start));
+
+    return start >= date_time + config_ptr->day_start && end <= date_time + config_ptr->day_end;
+}
+
+// private
+std::vector<Block> Database::shifted_blocks(const std::vector<block_key>& keys,
+                                            int days, int minutes) {
+    std::vector<Block> blocks;
+    int first_day = std::numeric_limits<int>::max(), last_day = std::numeric_limits<int>::min();
+
+    for (const block_key& key : keys) {
+        Block block = block_list[index_at_time(key.start, key.track)];
+        block.set_time_t_start(Calendar::shift_days(key.start, days) + 60 * minutes);
+
+        first_day = std::min(first_day, block.get_day());
+        last_day = std::max(last_day, block.get_day());
+        blocks.push_back(block);
     }
+
+    // before anything is checked there, the occurrences take up room too
+    if (!blocks.empty()) expand_series(first_day, last_day);
+
+    return blocks;
 }
+
 // public
-bool Database::extend_top_down(time_t block_time) {
-    int idx = index_at_time(block_time);
-    Block& block = block_list[idx]; // not a ref or pointer
-    
-    if (block.get_duration() <= 60) return false;
+bool Database::shift_blocks(const std::vector<block_key>& keys, int days, int minutes) {
+    if (keys.empty() || (days == 0 && minutes == 0)) return false;
 
-    block.set_time_t_start(block.get_time_t_start());
-    block.set_duration(block.get_duration());
+    std::vector<Block> targets = shifted_blocks(keys, days, minutes);
 
-    if (undo_vec.empty()) {
-        undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
-    } else {
-        action last_act = undo_vec.back();
-        Block last_block = last_act.block;
+    // the blocks move out of each other's way, so only the others can be in it
+    for (const block_key& key : keys) {
+        const Block& block = block_list[index_at_time(key.start, key.track)];
+        occupancy[key.track].remove(block.get_time_t_start(), block.get_time_t_end());
+    }
 
-        if (last_act.type == ACT_MODIFY
-            && last_act.index == idx
-            && last_block.get_id() == block.get_id()
-            && last_block.get_title() == block.get_title()
-            && last_block.get_collapsible() == block.get_collapsible()
-            && last_block.get_important() == block.get_important()
-            && last_block.get_date_time() == block.get_date_time()
-            && last_block.get_color() == block.get_color()
-        ) {
-            // last action was also a move of this block, so lets not make another save
-        } else {
-            undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
-        }
+    bool fits = true;
+    for (const Block& target : targets) {
+        time_t start = target.get_time_t_start(), end = target.get_time_t_end();
+        fits = fits && fits_in_day(start, end)
+                    && occupancy[target.get_track()].is_free(start, end);
     }
-    
-    block.set_time_t_start(block.get_time_t_start() + 60);
-    block.set_duration(block.get_duration() - 60);
 
-    block.save_to_file();
+    for (const block_key& key : keys) {
+        const Block& block = block_list[index_at_time(key.start, key.track)];
+        occupancy[key.track].add(block.get_time_t_start(), block.get_time_t_end());
+    }
+
+    if (!fits) return false;
+
+    // one at a time, the one furthest along the way first, so none lands on another
+    // (undoing goes back the same way in reverse)
+    std::vector<block_key> order = keys;
+    std::sort(order.begin(), order.end(), [](const block_key& l, const block_key& r) {
+        return (l.start != r.start)? l.start < r.start : l.track < r.track; });
+    if (targets[0].get_time_t_start() > keys[0].start) std::reverse(order.begin(), order.end());
+
+    begin_transaction();
+
+    for (const block_key& key : order) {
+        size_t idx = own_block(index_at_time(key.start, key.track));
+
+        Block block = block_list[idx];
+        erase_block(idx);
+
+        block.set_time_t_start(block.get_time_t_start()); // flag as modified
+        action act = { ACT_MODIFY, -1, block };
+
+        block.set_time_t_start(Calendar::shift_days(key.start, days) + 60 * minutes);
+        block.save_to_file();
+
+        act.index = insert_block(block);
+        push_undo(act);
+    }
+
+    end_transaction();
 
     return true;
 }
 
 // public
-bool Database::extend_bottom_up(time_t block_time) {
-    int idx = index_at_time(block_time);
-    Block& block = block_list[idx]; // not a ref or pointer
-    
-    if (block.get_duration() <= 60) return false;
+bool Database::copy_blocks(const std::vector<block_key>& keys, int days, int minutes) {
+    if (keys.empty() || (days == 0 && minutes == 0)) return false;
 
-    block.set_duration(block.get_duration());
+    std::vector<Block> copies = shifted_blocks(keys, days, minutes);
+    return add_copies(copies);
+}
 
-    if (undo_vec.empty()) {
-        undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
-    } else {
-        action last_act = undo_vec.back();
-        Block last_block = last_act.block;
+// public
+bool Database::copy_blocks(const std::vector<block_key>& keys, const std::vector<int>& minutes) {
+    if (keys.empty() || keys.size() != minutes.size()) return false;
 
-        if (last_act.type == ACT_MODIFY
-            && last_act.index == idx
-            && last_block.get_id() == block.get_id()
-            && last_block.get_title() == block.get_title()
-            && last_block.get_collapsible() == block.get_collapsible()
-            && last_block.get_important() == block.get_important()
-            && last_block.get_date_time() == block.get_date_time()
-            && last_block.get_color() == block.get_color()
-        ) {
-            // last action was also a move of this block, so lets not make another save
-        } else {
-            undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
-        }
+    std::vector<Block> copies;
+    int first_day = std::numeric_limits<int>::max(), last_day = std::numeric_limits<int>::min();
+
+    for (size_t i = 0; i < keys.size(); i++) {
+        Block copy = block_list[index_at_time(keys[i].start, keys[i].track)];
+        copy.set_time_t_start(keys[i].start + 60 * (time_t) minutes[i]);
+
+        first_day = std::min(first_day, copy.get_day());
+        last_day = std::max(last_day, copy.get_day());
+        copies.push_back(copy);
     }
-    
-    block.set_duration(block.get_duration() - 60);
-    block.save_to_file();
+
+    expand_series(first_day, last_day); // like shifted_blocks
+    return add_copies(copies);
+}
+
+// private
+bool Database::add_copies(std::vector<Block>& copies) {
+    // the originals stay, so they can be in the way as well
+    for (const Block& copy : copies) {
+        time_t start = copy.get_time_t_start(), end = copy.get_time_t_end();
+        if (!fits_in_day(start, end) || !occupancy[copy.get_track()].is_free(start, end))
+            return false;
+    }
+
+    begin_transaction();
+    for (Block& copy : copies) add_block(copy);
+    end_transaction();
 
     return true;
 }
 
 // public
-bool Database::extend_bottom_down(time_t block_time) {
-    int idx = index_at_time(block_time);
-    Block& block = block_list[idx]; // not a ref or pointer
+void Database::set_blocks_color(const std::vector<block_key>& keys, std::string col) {
+    begin_transaction();
+    for (const block_key& key : keys) set_block_color(key.start, key.track, col);
+    end_transaction();
+}
 
-    time_t next_block_start = block.get_date_time()
-                            + 60*60*config_ptr->num({"time", "day_end_hour"})
-                            + 60*config_ptr->num({"time", "day_end_minute"});
+// public
+void Database::set_blocks_important(const std::vector<block_key>& keys, bool important) {
+    begin_transaction();
 
-    if (idx != block_list.size()-1) {
-        next_block_start = std::min(next_block_start,
-                                    block_list[idx+1].get_time_t_start());
+    for (const block_key& key : keys) {
+        if (block_list[index_at_time(key.start, key.track)].get_important() != important)
+            block_toggle_important(key.start, key.track);
     }
 
-    if (block_time + block.get_duration() >= next_block_start) return false;
-    else {
+    end_transaction();
+}
 
-        block.set_duration(block.get_duration());
+// public
+void Database::set_blocks_collapsible(const std::vector<block_key>& keys, bool collapsible) {
+    begin_transaction();
 
-        // check last save, if it was this block moving, we don't make a history save
-        if (undo_vec.empty()) {
-            undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
-        } else {
-            action last_act = undo_vec.back();
-            Block last_block = last_act.block;
+    for (const block_key& key : keys) {
+        if (block_list[index_at_time(key.start, key.track)].get_collapsible() != collapsible)
+            block_toggle_collapsible(key.start, key.track);
+    }
 
-            if (last_act.type == ACT_MODIFY
-                && last_act.index == idx
-                && last_block.get_id() == block.get_id()
-                && last_block.get_title() == block.get_title()
-                && last_block.get_collapsible() == block.get_collapsible()
-                && last_block.get_important() == block.get_important()
-                && last_block.get_date_time() == block.get_date_time()
-                && last_block.get_color() == block.get_color()
-            ) {
-                // last action was also a move of this block, so lets make another save
-            } else {
-                undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
-            }
-        }
+    end_transaction();
+}
 
-        block.set_duration(block.get_duration() + 60);
-        block.save_to_file();
+// public
+void Database::remove_blocks(const std::vector<block_key>& keys) {
+    begin_transaction();
+    for (const block_key& key : keys) remove_block(key.start, key.track);
+    end_transaction();
+}
 
-        return true;
+// private
+void Database::shift_block_edges(size_t idx, time_t top_delta, time_t bottom_delta) {
+    begin_transaction();
+    idx = own_block(idx);
+    Block& block = block_list[idx];
+
+    // flag both as modified, so undoing rewrites them
+    block.set_time_t_start(block.get_time_t_start());
+    block.set_duration(block.get_duration());
+
+    push_edit_undo(idx, block);
+
+    add_to_summary(block, -1);
+    occupancy[block.get_track()].remove(block.get_time_t_start(), block.get_time_t_end());
+    block.set_time_t_start(block.get_time_t_start() + top_delta);
+    block.set_duration(block.get_duration() + bottom_delta - top_delta);
+    occupancy[block.get_track()].add(block.get_time_t_start(), block.get_time_t_end());
+    add_to_summary(block, 1);
+
+    block.save_to_file();
+    end_transaction();
+}
+
+// private
+void Database::push_edit_undo(int idx, const Block& block) {
+    // if the last save was this block moving, we don't make another history save
+    if (!undo_vec.empty()) {
+        const action& last_act = undo_vec.back();
+        const Block& last_block = last_act.block;
+
+        if (last_act.type == ACT_MODIFY
+            && last_act.index == idx
+            && last_block.get_id() == block.get_id()
+            && last_block.get_title() == block.get_title()
+            && last_block.get_collapsible() == block.get_collapsible()
+            && last_block.get_important() == block.get_important()
+            && last_block.get_date_time() == block.get_date_time()
+            && last_block.get_color() == block.get_color()
+        ) return;
     }
+
+    push_undo({ ACT_MODIFY, idx, block }); // save prev state
 }
 
 // public
-bool Database::set_block_color(time_t block_time, std::string col) {
-    int idx = index_at_time(block_time);
+bool Database::set_block_color(time_t block_time, int track, std::string col) {
+    int idx = index_at_time(block_time, track);
+    if (block_list[idx].get_color_str() == col) return false;
+
+    begin_transaction();
+    idx = own_block(idx);
     Block& block = block_list[idx];
-    
-    if (block.get_color_str() == col) return false;
 
     block.set_color_str(block.get_color_str());
 
-    undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
+    push_undo({ ACT_MODIFY, idx, block }); // save prev state
     
+    add_to_summary(block, -1);
     block.set_color_str(col);
+    add_to_summary(block, 1);
     block.save_to_file();
+    end_transaction();
 
     return true;
 }
 
 // public
-void Database::block_toggle_important(time_t block_time) {
-    int idx = index_at_time(block_time);
+void Database::block_toggle_important(time_t block_time, int track) {
+    begin_transaction();
+    int idx = own_block(index_at_time(block_time, track));
     Block& block = block_list[idx];
 
     block.set_important(block.get_important());
 
-    undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
+    push_undo({ ACT_MODIFY, idx, block }); // save prev state
     
+    add_to_summary(block, -1);
     block.toggle_important();
+    add_to_summary(block, 1);
     block.save_to_file();
+    end_transaction();
 }
 
-void Database::block_toggle_collapsible(time_t block_time) {
-    int idx = index_at_time(block_time);
+void Database::block_toggle_collapsible(time_t block_time, int track) {
+    begin_transaction();
+    int idx = own_block(index_at_time(block_time, track));
     Block& block = block_list[idx];
 
     block.set_collapsible(block.get_collapsible());
 
-    undo_vec.push_back({ ACT_MODIFY, idx, block }); // save prev state
+    push_undo({ ACT_MODIFY, idx, block }); // save prev state
     
     block.toggle_collapsible();
     block.save_to_file();
+    end_transaction();
 }
 
 // public
-time_t Database::edit_block_source(time_t block_time) {
-    // take the block out
-    size_t idx = index_at_time(block_time);
-    Block block = block_list[idx];
-    block_list.erase(block_list.begin() + idx);
+time_t Database::edit_block_source(time_t block_time, int track) {
+    Block block = block_list[index_at_time(block_time, track)];
+    int day = block.get_day();
+
+    // an occurrence opens the file of its series, so the edit goes to all of them
+    int id = (block.get_group() != 0)? block.get_group() : block.get_id();
+    Block old_block = take_file_block(id);
 
     def_prog_mode();
 	endwin();
-    std::string command = block.get_source_file_str();
+    std::string command = old_block.get_source_file_str();
     command = "xdg-open \""+command+"\"";
 	system(command.c_str());
-    // NOTE: 'block' is now inconsistent with file state
+    // NOTE: 'old_block' is now inconsistent with file state
 	reset_prog_mode();
 
     // put the edited block in
-    Block new_block = Block(block.get_source_file(), config_ptr);
-    int new_idx = insert_block(new_block); // reinsert the new edited block
+    Block new_block = Block(old_block.get_source_file(), config_ptr);
+    put_file_block(new_block);
 
-    if (block != new_block) {
-        block.set_all_modified(); // we don't know what was modified, just flag all
-        undo_vec.push_back({ ACT_MODIFY, new_idx, block }); // save *OLD* block
+    if (old_block != new_block) {
+        old_block.set_all_modified(); // we don't know what was modified, just flag all
+
+        if (old_block.is_recurring() || new_block.is_recurring())
+            push_undo({ ACT_SERIES, 0, old_block, 0, day });
+        else
+            push_undo({ ACT_MODIFY, int(index_of_id(id)), old_block }); // save *OLD* block
     }
     
-    return new_block.get_date_time();
+    return new_block.is_recurring()? Calendar::midnight(day) : new_block.get_date_time();
 }
 
 // public
 bool Database::copy_block(Block& block, time_t target_start) {
-    tm tmp = *std::localtime(&target_start);
-    tmp.tm_hour = tmp.tm_min = tmp.tm_sec = 0;
-    time_t target_date_time = std::mktime(&tmp);
+    block.set_time_t_start(target_start);
+    return add_block(block);
+}
+
+// public
+bool Database::add_block(Block& block) {
+    time_t start = block.get_time_t_start();
+    time_t end = block.get_time_t_end();
+    time_t date_time = Calendar::midnight(Calendar::day_of(start));
+    expand_series(Calendar::day_of(start), Calendar::day_of(start));
+
+    // within the day and clear of other blocks on its track
+    if (start < date_time + config_ptr->day_start) return false;
+    if (end > date_time + config_ptr->day_end) return false;
+    if (!occupancy[block.get_track()].is_free(start, end)) return false;
+
+    if (block.get_group() != 0) { // a copy of an occurrence gets a file without the series
+        block.set_group(0);
+        block.set_source_file("");
+        block.set_all_modified();
+    }
 
-    time_t prev_block_end = target_date_time +
-                           + 60*60*config_ptr->num({"time", "day_start_hour"})
-                           + 60*config_ptr->num({"time", "day_start_minute"});
+    begin_transaction();
+    block.set_id(fresh_id());
+    block.save_to_file();
 
-    time_t next_block_start = target_date_time +
-                            + 60*60*config_ptr->num({"time", "day_end_hour"})
-                            + 60*config_ptr->num({"time", "day_end_minute"});
+    push_undo({ ACT_CREATE, int(insert_block(block)), block });
+    end_transaction();
 
-    size_t idx_before = index_before_time(target_start);
-    size_t idx_after = index_after_time(target_start + block.get_duration());
+    return true;
+}
 
-    if (idx_before != -1) {
-        prev_block_end = std::max
-            (prev_block_end, block_list[idx_before].get_time_t_end());
+// public
+int Database::add_blocks(std::vector<Block> blocks) {
+    if (blocks.empty()) return 0;
+
+    std::sort(blocks.begin(), blocks.end(), sorts_before);
+    expand_series(blocks.front().get_day(), blocks.back().get_day());
+
+    // the occupancy has everything already there, and in order the new ones
+    // can only run into the one before them on their track
+    std::vector<Block> fitting;
+    std::unordered_set<int> batch_ids; // handed out here, only taken once all are written
+    time_t last_end[Block::TRACK_COUNT];
+    std::fill(last_end, last_end + Block::TRACK_COUNT, std::numeric_limits<time_t>::min());
+
+    for (Block& block : blocks) {
+        time_t start = block.get_time_t_start();
+        time_t end = block.get_time_t_end();
+        int track = block.get_track();
+
+        if (!fits_in_day(start, end) || !occupancy[track].is_free(start, end)) continue;
+        if (last_end[track] > start) continue;
+        last_end[track] = end;
+
+        block.set_group(0);
+        block.set_source_file("");
+        block.set_all_modified();
+        int id = fresh_id();
+        while (batch_ids.count(id) != 0) id = fresh_id();
+        batch_ids.insert(id);
+        block.set_id(id);
+
+        fitting.push_back(block);
     }
 
-    if (idx_after != -1) {
-        next_block_start = std::min
-            (next_block_start, block_list[idx_after].get_time_t_start());
+    // every block has a file of its own, so they are written side by side
+    size_t thread_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8);
+    size_t chunk = (fitting.size() + thread_count - 1) / thread_count;
+    std::vector<std::future<void>> writers;
+
+    for (size_t first = 0; first < fitting.size(); first += chunk) {
+        writers.push_back(std::async(std::launch::async, [&fitting, first, chunk]() {
+            size_t last = std::min(first + chunk, fitting.size());
+            for (size_t i = first; i < last; i++) fitting[i].save_to_file();
+        }));
     }
 
-    if (prev_block_end <= target_start) {
-        if (next_block_start >= target_start + block.get_duration()) {
+    // every writer is waited for, they all write into fitting
+    std::exception_ptr failure;
+    for (std::future<void>& writer : writers) {
+        try {
+            writer.get();
+        } catch (...) {
+            if (failure == nullptr) failure = std::current_exception();
+        }
+    }
 
-            block.set_id(fresh_id());
-            block.set_time_t_start(target_start);
-            block.save_to_file();
+    // all or nothing: the files that did get written go again, and the error goes on
+    if (failure != nullptr) {
+        for (Block& block : fitting)
+            if (!block.get_source_file_str().empty()) block.delete_file();
+
+        std::rethrow_exception(failure);
+    }
 
-            undo_vec.push_back({ ACT_CREATE, int(insert_block(block)), block});
+    id_set.insert(batch_ids.begin(), batch_ids.end());
 
-            return true;
+    begin_transaction();
+    insert_blocks(fitting);
+    for (const Block& block : fitting) push_undo({ ACT_CREATE, 0, block });
+    end_transaction();
+
+    return fitting.size();
+}
+
+// public
+bool Database::find_block(int id, Block& block) {
+    auto series = series_map.find(id);
+
+    if (series != series_map.end()) {
+        int today = Calendar::today();
+        block = series->second;
+
+        for (int day = std::max(today, block.get_day()); day <= today + 366; day++) {
+            if (!series->second.recurs_on(day)) continue;
+
+            expand_series(day, day);
+            block = series->second.occurrence_on(day);
+            break;
         }
+
+        return true;
+    }
+
+    for (const Block& other : block_list) {
+        if (other.get_id() != id || other.get_group() != 0) continue;
+
+        block = other;
+        return true;
     }
 
     return false;
 }
 
+// public
+time_t Database::find_free_slot(time_t start, time_t duration, time_t limit) {
+    expand_series(Calendar::day_of(start), Calendar::day_of(limit - 1));
+    return free_slot_on_all(start, duration, limit);
+}
+
+// public
+time_t Database::find_free_slot_before(time_t end, time_t duration, time_t limit) {
+    expand_series(Calendar::day_of(limit), Calendar::day_of(end - 1));
+    return free_slot_before_on_all(end, duration, limit);
+}
+
+// public
+time_t Database::find_free_slot_near(time_t from, time_t duration, bool backward) {
+    time_t day_start = config_ptr->day_start, day_end = config_ptr->day_end;
+    if (day_end - day_start < duration) return -1;
+
+    int step = backward? -1 : 1;
+    int day = Calendar::day_of(backward? from - 1 : from);
+    int last_day = day + step * 366;
+
+    // the day of from, only the part of it on the far side of from
+    time_t first = Calendar::midnight(day) + day_start, last = Calendar::midnight(day) + day_end;
+    if (backward) last = std::min(last, from);
+    else first = std::max(first, from);
+
+    if (first + duration <= last) {
+        time_t slot = backward? find_free_slot_before(last, duration, first)
+                              : find_free_slot(first, duration, last);
+        if (slot >= 0) return slot;
+    }
+
+    // the days after it at once, or a chunk at a time when series have to be expanded
+    for (int chunk_first = day + step; step * (last_day - chunk_first) >= 0;
+         chunk_first += step * RANGE_CHUNK_DAYS) {
+        int chunk_last = series_map.empty()? last_day
+                       : chunk_first + step * std::min(RANGE_CHUNK_DAYS - 1,
+                                                       step * (last_day - chunk_first));
+        expand_series(std::min(chunk_first, chunk_last), std::max(chunk_first, chunk_last));
+        update_gaps();
+
+        // the nearest day without blocks, or with a long enough stretch free
+        int found = free_day_from(chunk_first, step);
+        for (auto bucket = gap_days.lower_bound(duration); bucket != gap_days.end(); bucket++) {
+            const std::set<int>& days = bucket->second;
+
+            if (!backward) {
+                auto it = days.lower_bound(chunk_first);
+                if (it != days.end()) found = std::min(found, *it);
+            } else {
+                auto it = days.upper_bound(chunk_first);
+                if (it != days.begin()) found = std::max(found, *std::prev(it));
+            }
+        }
+
+        if (step * (chunk_last - found) >= 0) {
+            time_t midnight = Calendar::midnight(found);
+            return backward? free_slot_before_on_all(midnight + day_end, duration,
+                                                     midnight + day_start)
+                           : free_slot_on_all(midnight + day_start, duration, midnight + day_end);
+        }
+
+        if (series_map.empty()) break; // it was all one chunk
+    }
+
+    return -1;
+}
+
+// public
+bool Database::find_match(block_key key, bool backward, en_match match, const Block& like,
+                          int count, Block& found) {
+    int step = backward? -1 : 1;
+    int key_day = Calendar::day_of(key.start);
+
+    // occurrences are only in the index once their days are expanded, which only matters
+    // for series that match, and none of those have any before their first day
+    bool series_match = false;
+    int first_series_day = std::numeric_limits<int>::max();
+
+    for (const auto& [id, series] : series_map) {
+        if (!matches(series, match, like)) continue;
+
+        series_match = true;
+        first_series_day = std::min(first_series_day, series.get_day());
+    }
+
+    // how far it can find anything: the ends of the list, a year past it for the series
+    int last_day = key_day;
+    if (!backward && !block_list.empty())
+        last_day = std::max(key_day, block_list.back().get_day()) + (series_match? 366 : 0);
+    else if (!backward && series_match) last_day = key_day + 366;
+    else if (backward && !block_list.empty())
+        last_day = std::min(block_list.front().get_day(), first_series_day);
+    else if (backward && series_match) last_day = first_series_day;
+
+    // the blocks of a day that match, on the day of the key only the ones past it
+    bool any = false; // found is the last one so far
+    auto search_day = [&](int day) {
+        size_t first = index_after({ Calendar::midnight(day), -1 });
+        size_t last = index_after({ Calendar::midnight(day + 1), -1 });
+        if (day == key_day && backward) last = index_after({ key.start, key.track - 1 });
+        else if (day == key_day) first = std::max(first, index_after(key));
+
+        for (size_t i = 0; first + i < last; i++) {
+            const Block& block = block_list[backward? last - 1 - i : first + i];
+            if (!matches(block, match, like)) continue;
+
+            found = block;
+            any = true;
+            if (--count <= 0) return true;
+        }
+
+        return false;
+    };
+
+    for (int chunk_first = key_day; step * (last_day - chunk_first) >= 0;
+         chunk_first += step * RANGE_CHUNK_DAYS) {
+        int chunk_last = !series_match? last_day
+                       : chunk_first + step * std::min(RANGE_CHUNK_DAYS - 1,
+                                                       step * (last_day - chunk_first));
+        if (series_match)
+            expand_series(std::min(chunk_first, chunk_last), std::max(chunk_first, chunk_last));
+
+        // looked up after expanding, a title can first show up with the occurrences
+        std::map<int, int>* days = match_days(match, like);
+
+        if (days != nullptr && !backward) {
+            for (auto it = days->lower_bound(chunk_first);
+                 it != days->end() && it->first <= chunk_last; it++)
+                if (search_day(it->first)) return true;
+        } else if (days != nullptr) {
+            for (auto it = std::make_reverse_iterator(days->upper_bound(chunk_first));
+                 it != days->rend() && it->first >= chunk_last; it++)
+                if (search_day(it->first)) return true;
+        }
+
+        if (!series_match) break; // it was all one chunk
+    }
+
+    return any;
+}
+
+// private
+time_t Database::free_slot_on_all(time_t start, time_t duration, time_t limit) const {
+    // each track pushes the slot on past its blocks, until every track agrees on it
+    time_t slot = start;
+
+    for (int track = 0, agreeing = 0; agreeing < Block::TRACK_COUNT;
+         track = (track + 1) % Block::TRACK_COUNT) {
+        time_t next = occupancy[track].first_free(slot, duration, limit);
+        if (next < 0) return -1;
+
+        agreeing = (next == slot)? agreeing + 1 : 1;
+        slot = next;
+    }
+
+    return slot;
+}
+
+// private
+time_t Database::free_slot_before_on_all(time_t end, time_t duration, time_t limit) const {
+    // the same as above, each track pulls the end back before its blocks
+    time_t slot_end = end;
+
+    for (int track = 0, agreeing = 0; agreeing < Block::TRACK_COUNT;
+         track = (track + 1) % Block::TRACK_COUNT) {
+        time_t next = occupancy[track].last_free(slot_end, duration, limit);
+        if (next < 0) return -1;
+
+        agreeing = (next == slot_end)? agreeing + 1 : 1;
+        slot_end = next;
+    }
+
+    return slot_end - duration;
+}
+
+// private
+time_t Database::longest_free_on_all(time_t start, time_t end) const {
+    time_t longest = 0;
+
+    // from each stretch free on every track to the first block on any of them
+    for (time_t time = start; time < end; ) {
+        time = free_slot_on_all(time, 60, end);
+        if (time < 0) break;
+
+        time_t run = end - time;
+        for (int track = 0; track < Block::TRACK_COUNT; track++)
+            run = std::min(run, occupancy[track].free_after(time, end));
+
+        longest = std::max(longest, run);
+        time += run;
+    }
+
+    return longest;
+}
+
+// public
+void Database::begin_transaction() {
+    if (transaction_depth++ == 0) current_batch = ++batch_count;
+}
+
+// public
+void Database::end_transaction() {
+    if (--transaction_depth == 0) current_batch = 0;
+}
+
+// private
+void Database::push_undo(action act) {
+    act.batch = current_batch;
+    undo_vec.push_back(act);
+}
+
 // public
 std::tuple<time_t, int> Database::undo() {
     if (undo_vec.empty()) return {0, 0};
@@ -555,7 +1023,7 @@ std::tuple<time_t, int> Database::undo() {
     // redo_vec.push_back(undo_action(undo_vec.back()));
     // undo_vec.pop_back();
     
-    return undo_action(&undo_vec, &redo_vec);
+    return undo_batch(&undo_vec, &redo_vec);
 
     // return { redo_vec.back().block.get_time_t_start(), };
 }
@@ -566,11 +1034,24 @@ std::tuple<time_t, int> Database::redo() {
 
     // undo_vec.push_back(undo_action(redo_vec.back()));
     // redo_vec.pop_back();
-    return undo_action(&redo_vec, &undo_vec);
+    return undo_batch(&redo_vec, &undo_vec);
 
     // return undo_vec.back().block.get_time_t_start();
 }
 
+// private
+std::tuple<time_t, int> Database::undo_batch(std::vector<struct action> *from,
+                                       std::vector<struct action> *to) {
+    int batch = from->back().batch;
+    std::tuple<time_t, int> ret = undo_action(from, to);
+
+    // the rest of a transaction goes with it, the first one undone is the one reported
+    while (batch != 0 && !from->empty() && from->back().batch == batch)
+        undo_action(from, to);
+
+    return ret;
+}
+
 // private
 std::tuple<time_t, int> Database::undo_action(std::vector<struct action> *from,
                                         std::vector<struct action> *to) {
@@ -581,8 +1062,9 @@ std::tuple<time_t, int> Database::undo_action(std::vector<struct action> *from,
 
     switch (act.type) {
         case ACT_MODIFY:
+            act.index = index_of_id(act.block.get_id()); // series expansions shift the list
             block = block_list[act.index];
-            block_list.erase(block_list.begin() + act.index); // +
+            erase_block(act.index); // +
 
             act.block.save_to_file(); // overwrite old info
             act.index = insert_block(act.block); // +
@@ -590,6 +1072,7 @@ std::tuple<time_t, int> Database::undo_action(std::vector<struct action> *from,
 
             // so that when this is written, it has the correct old source file
             block.set_source_file(act.block.get_source_file());
+            block.set_all_modified(); // its fields were saved, redoing has to write them again
             act.block = block; // everything else remains the same
             
             to->push_back(act);
@@ -597,12 +1080,27 @@ std::tuple<time_t, int> Database::undo_action(std::vector<struct action> *from,
         case ACT_CREATE:
             // we need to delete the block
             // TODO figure out the fact that now the file is dead but block doesn't know
+            act.index = index_of_id(act.block.get_id());
             block = block_list[act.index];
-            block_list.erase(block_list.begin() + act.index);
+            erase_block(act.index);
             block.delete_file();
 
-            to->push_back({ ACT_DELETE, 0, block });
+            to->push_back({ ACT_DELETE, 0, block, act.batch });
             break;
+        case ACT_SERIES: {
+            // whatever has the id now goes back to how it was, series or not
+            block = take_file_block(act.block.get_id());
+
+            act.block.set_source_file(block.get_source_file());
+            act.block.save_to_file();
+            put_file_block(act.block);
+
+            block.set_source_file(act.block.get_source_file()); // where it is now
+            block.set_all_modified();
+            to->push_back({ ACT_SERIES, 0, block, act.batch, act.day });
+
+            return { Calendar::midnight(act.day), act.block.get_id() };
+        }
         case ACT_DELETE:
             // we need to create the block
             // in theory if the undo was initialized correctly
@@ -613,7 +1111,7 @@ std::tuple<time_t, int> Database::undo_action(std::vector<struct action> *from,
             block.save_to_file();
             int idx = insert_block(block);
 
-            to->push_back({ ACT_CREATE, idx, block });
+            to->push_back({ ACT_CREATE, idx, block, act.batch });
             break;
     }
 
@@ -621,41 +1119,449 @@ std::tuple<time_t, int> Database::undo_action(std::vector<struct action> *from,
 }
 
 // public
-void Database::remove_block(time_t block_time) {
-    int idx = index_at_time(block_time);
+void Database::remove_block(time_t block_time, int track) {
+    int idx = index_at_time(block_time, track);
+
+    if (block_list[idx].get_group() != 0) { // the series just skips that day from now on
+        skip_occurrence(idx);
+        return;
+    }
 
     Block old_block = block_list[idx];
 
-    block_list.erase(block_list.begin() + idx);
+    erase_block(idx);
     old_block.delete_file();
 
-    undo_vec.push_back({ ACT_DELETE, 0, old_block });
+    push_undo({ ACT_DELETE, 0, old_block });
+}
+
+// public
+bool Database::ripple_insert(time_t block_time, int track) {
+    int day = Calendar::day_of(block_time);
+    time_t day_end = Calendar::midnight(day) + config_ptr->day_end;
+    expand_series(day, day);
+
+    if (block_time < Calendar::midnight(day) + config_ptr->day_start) return false;
+    if (block_time >= day_end) return false;
+
+    auto it = std::lower_bound(block_list.begin(), block_list.end(), block_time,
+        [](const Block& block, time_t t) { return block.get_time_t_start() < t; });
+
+    std::vector<block_key> keys;
+    time_t last_end = block_time;
+
+    for (; it != block_list.end() && it->get_time_t_start() < day_end; it++) {
+        if (it->get_track() != track) continue; // the other tracks stay where they are
+
+        keys.push_back({ it->get_time_t_start(), track });
+        last_end = it->get_time_t_end();
+    }
+
+    // nothing is cut in two, the minute is free or the first block moving starts there
+    bool starts_here = !keys.empty() && keys[0].start == block_time;
+    if (!starts_here && !occupancy[track].is_free(block_time, block_time + 60)) return false;
+
+    // everything after it moves as far as the new block is long, so that is what has to fit
+    time_t duration = std::min(config_ptr->default_block_duration, day_end - last_end);
+    if (duration <= 0) return false;
+
+    begin_transaction();
+    ripple_shift(keys, duration);
+
+    Block block(config_ptr, fresh_id());
+    block.set_time_t_start(block_time);
+    block.set_duration(duration);
+    block.set_track(track);
+    block.save_to_file();
+
+    push_undo({ ACT_CREATE, int(insert_block(block)), block });
+    end_transaction();
+
+    return true;
+}
+
+// public
+void Database::ripple_remove(time_t block_time, int track) {
+    size_t idx = index_at_time(block_time, track);
+    time_t duration = block_list[idx].get_duration();
+    time_t day_end = block_list[idx].get_date_time() + config_ptr->day_end;
+
+    std::vector<block_key> keys;
+    for (idx++; idx < block_list.size() && block_list[idx].get_time_t_start() < day_end; idx++)
+        if (block_list[idx].get_track() == track)
+            keys.push_back({ block_list[idx].get_time_t_start(), track });
+
+    begin_transaction();
+    remove_block(block_time, track);
+    ripple_shift(keys, -duration);
+    end_transaction();
+}
+
+// private
+void Database::ripple_shift(const std::vector<block_key>& keys, time_t delta) {
+    // the one furthest along first, so none lands on one that didn't move yet
+    std::vector<block_key> order = keys;
+    if (delta > 0) std::reverse(order.begin(), order.end());
+
+    for (const block_key& key : order) {
+        size_t idx = index_at_time(key.start, key.track);
+        time_t block_time = key.start;
+
+        if (block_list[idx].get_group() != 0) {
+            // an occurrence leaves its series right where it goes, its file is new
+            Block block = detach_occurrence(idx);
+            block.set_time_t_start(block_time + delta);
+            block.save_to_file();
+
+            push_undo({ ACT_CREATE, int(insert_block(block)), block });
+            continue;
+        }
+
+        Block block = block_list[idx];
+        erase_block(idx);
+
+        block.set_time_t_start(block_time); // flag as modified
+        action act = { ACT_MODIFY, -1, block };
+
+        block.set_time_t_start(block_time + delta);
+        block.save_to_file();
+
+        act.index = insert_block(block);
+        push_undo(act);
+    }
+}
+
+// private
+size_t Database::insert_block(const Block& new_block) {
+    bool occurrence = new_block.get_group() != 0; // shares the id of its series
+
+    // binary search for the first block not before this one
+    auto it = std::lower_bound(block_list.begin(), block_list.end(), new_block, sorts_before);
+
+    if (!occurrence && id_set.count(new_block.get_id()) != 0) {
+        int id = new_block.get_id();
+        std::string other_file = (series_map.count(id) != 0)?
+            series_map.at(id).get_source_file_str()
+          : block_list[index_of_id(id)].get_source_file_str();
+
+        throw std::runtime_error("two blocks have conflicting ids:\n"
+                                 + new_block.get_source_file_str()+"\n" + other_file);
+    }
+
+    if (it != block_list.end() && it->get_time_t_start() == new_block.get_time_t_start()
+        && it->get_track() == new_block.get_track())
+        throw std::runtime_error("two blocks have conflicting start time and track:\n"
+                                 + new_block.get_source_file_str()+"\n"
+                                 + it->get_source_file_str());
+
+    add_to_summary(new_block, 1);
+    occupancy[new_block.get_track()].add(new_block.get_time_t_start(),
+                                         new_block.get_time_t_end());
+    if (!occurrence) id_set.insert(new_block.get_id());
+
+    return block_list.insert(it, new_block) - block_list.begin();
 }
 
-size_t Database::insert_block(Block new_block) {
+// private
+void Database::insert_blocks(const std::vector<Block>& new_blocks) {
+    for (const Block& block : new_blocks) {
+        add_to_summary(block, 1);
+        occupancy[block.get_track()].add(block.get_time_t_start(), block.get_time_t_end());
+    }
+
+    // one merge instead of moving the tail of the list for every block
+    size_t middle = block_list.size();
+    block_list.insert(block_list.end(), new_blocks.begin(), new_blocks.end());
+    std::inplace_merge(block_list.begin(), block_list.begin() + middle, block_list.end(),
+                       sorts_before);
+}
+
+// private
+void Database::erase_block(size_t idx) {
+    add_to_summary(block_list[idx], -1);
+    occupancy[block_list[idx].get_track()].remove(block_list[idx].get_time_t_start(),
+                                                  block_list[idx].get_time_t_end());
+    if (block_list[idx].get_group() == 0) id_set.erase(block_list[idx].get_id());
+    block_list.erase(block_list.begin() + idx);
+}
+
+// private
+size_t Database::index_of_id(int id) const {
     for (size_t i = 0; i < block_list.size(); i++) {
-        Block other_block = block_list[i];
+        if (block_list[i].get_id() == id && block_list[i].get_group() == 0) return i;
+    }
+
+    throw std::runtime_error(error_str + ", no block with id: " + std::to_string(id));
+}
+
+// private
+void Database::put_file_block(Block block) {
+    block.set_group(0); // only occurrences are in a group, and they have no files
+
+    if (!block.is_recurring()) {
+        insert_block(block);
+        return;
+    }
+
+    if (id_set.count(block.get_id()) != 0)
+        throw std::runtime_error("two blocks have conflicting ids:\n"
+                                 + block.get_source_file_str());
+
+    series_map.insert_or_assign(block.get_id(), block);
+    id_set.insert(block.get_id());
+
+    for (const auto& [first_day, last_day] : expanded_ranges)
+        expand_one(block, first_day, last_day);
+}
+
+// private
+Block Database::take_file_block(int id) {
+    auto it = series_map.find(id);
+
+    if (it == series_map.end()) {
+        size_t idx = index_of_id(id);
+        Block block = block_list[idx];
+        erase_block(idx);
+
+        return block;
+    }
+
+    // the occurrences go with it
+    for (size_t i = block_list.size(); i-- > 0;)
+        if (block_list[i].get_group() == id) erase_block(i);
+
+    Block block = it->second;
+    series_map.erase(it);
+    id_set.erase(id);
+
+    return block;
+}
+
+// private
+size_t Database::own_block(size_t idx) {
+    if (block_list[idx].get_group() == 0) return idx;
+
+    // it comes back as a block with a file of its own, at the same time
+    Block block = detach_occurrence(idx);
+    block.save_to_file();
+
+    idx = insert_block(block);
+    push_undo({ ACT_CREATE, int(idx), block });
+
+    return idx;
+}
+
+// private
+Block Database::detach_occurrence(size_t idx) {
+    Block block = block_list[idx];
+    skip_occurrence(idx);
+
+    block.set_group(0);
+    block.set_source_file("");
+    block.set_all_modified();
+    block.set_id(fresh_id());
+
+    return block;
+}
+
+// private
+void Database::skip_occurrence(size_t idx) {
+    int day = block_list[idx].get_day();
+    Block& series = series_map.at(block_list[idx].get_group());
+
+    Block old_series = series;
+    old_series.set_all_modified();
+    push_undo({ ACT_SERIES, 0, old_series, 0, day });
+
+    series.skip_day(day);
+    series.save_to_file(); // the only file that changes
+    erase_block(idx);
+}
+
+// private
+void Database::expand_series(int first_day, int last_day) {
+    // the parts of the range that weren't expanded yet
+    std::vector<std::pair<int, int>> gaps;
+    int cursor = first_day;
+
+    auto it = expanded_ranges.upper_bound(first_day);
+    if (it != expanded_ranges.begin()) cursor = std::max(cursor, std::prev(it)->second + 1);
 
-        if (new_block.get_id() == other_block.get_id())
-            throw std::runtime_error("two blocks have conflicting ids:\n"
-                                     + new_block.get_source_file_str()+"\n"
-                                     + other_block.get_source_file_str());
+    for (; it != expanded_ranges.end() && it->first <= last_day; it++) {
+        if (it->first > cursor) gaps.push_back({ cursor, it->first - 1 });
+        cursor = std::max(cursor, it->second + 1);
+    }
+
+    if (cursor <= last_day) gaps.push_back({ cursor, last_day });
+    if (gaps.empty()) return; // memoized, the usual case once a day was drawn
+
+    for (const auto& [gap_first, gap_last] : gaps)
+        for (const auto& [id, series] : series_map) expand_one(series, gap_first, gap_last);
+
+    // merge with the ranges it overlaps or touches
+    int merged_first = first_day, merged_last = last_day;
+
+    auto low = expanded_ranges.lower_bound(first_day);
+    if (low != expanded_ranges.begin() && std::prev(low)->second >= first_day - 1) low--;
+
+    auto high = low;
+    for (; high != expanded_ranges.end() && high->first <= last_day + 1; high++) {
+        merged_first = std::min(merged_first, high->first);
+        merged_last = std::max(merged_last, high->second);
+    }
+
+    expanded_ranges.erase(low, high);
+    expanded_ranges[merged_first] = merged_last;
+}
+
+// private
+void Database::expand_one(const Block& series, int first_day, int last_day) {
+    for (int day = std::max(first_day, series.get_day()); day <= last_day; day++) {
+        if (!series.recurs_on(day)) continue;
+
+        // blocks of their own on the same track win over the series
+        Block occurrence = series.occurrence_on(day);
+        if (occupancy[occurrence.get_track()].is_free(occurrence.get_time_t_start(),
+                                                      occurrence.get_time_t_end()))
+            insert_block(occurrence);
+    }
+}
+
+// private
+void Database::add_to_summary(const Block& block, int sign) {
+    int day = block.get_day();
+    if (summary_map.count(day) == 0) set_busy(day, true);
+    day_summary& summary = summary_map[day]; // zeroed when new
+
+    int minutes = block.get_duration() / 60;
+    summary.busy_minutes += sign * minutes;
+    summary.block_count += sign;
+    summary.important_count += sign * block.get_important();
+    summary.color_minutes[block.get_color()] += sign * minutes;
+
+    if (summary.block_count == 0) {
+        summary_map.erase(day);
+        set_busy(day, false);
+    }
+
+    // the jump indexes
+    if (block.get_important()) count_day(important_days, day, sign);
+    count_day(color_days[block.get_color()], day, sign);
+
+    std::map<int, int>& titled = title_days[block.get_title()];
+    count_day(titled, day, sign);
+    if (titled.empty()) title_days.erase(block.get_title());
+
+    stale_gaps.insert(day); // the occupancy isn't always up to date yet
+}
+
+// private
+void Database::count_day(std::map<int, int>& days, int day, int sign) {
+    int& count = days[day];
+    count += sign;
+    if (count == 0) days.erase(day);
+}
+
+// private
+bool Database::matches(const Block& block, en_match match, const Block& like) {
+    switch (match) {
+        case MATCH_IMPORTANT: return block.get_important();
+        case MATCH_COLOR:     return block.get_color() == like.get_color();
+        case MATCH_TITLE:     return block.get_title() == like.get_title();
+    }
+
+    return false;
+}
 
-        if (new_block.get_time_t_start() == other_block.get_time_t_start())
-            throw std::runtime_error("two blocks have conflicting start time:\n"
-                                     + new_block.get_source_file_str()+"\n"
-                                     + other_block.get_source_file_str());
+// private
+std::map<int, int>* Database::match_days(en_match match, const Block& like) {
+    if (match == MATCH_IMPORTANT) return &important_days;
+    if (match == MATCH_COLOR) return &color_days[like.get_color()];
+
+    auto it = title_days.find(like.get_title());
+    return (it == title_days.end())? nullptr : &it->second;
+}
 
-        if (new_block.get_time_t_start() > other_block.get_time_t_start()) {
-            continue; // then the new block should go after this one
+// private
+void Database::set_busy(int day, bool busy) {
+    auto next = busy_runs.upper_bound(day); // the first run starting after the day
+    auto run = (next == busy_runs.begin())? busy_runs.end() : std::prev(next);
+    bool inside = run != busy_runs.end() && run->second >= day;
+
+    if (busy && !inside) {
+        int first = day, last = day;
+
+        // joins up with the runs right before and after it
+        if (run != busy_runs.end() && run->second == day - 1) {
+            first = run->first;
+            busy_runs.erase(run);
         }
+        if (next != busy_runs.end() && next->first == day + 1) {
+            last = next->second;
+            busy_runs.erase(next);
+        }
+
+        busy_runs[first] = last;
+    } else if (!busy && inside) {
+        int first = run->first, last = run->second;
+        busy_runs.erase(run);
 
-        block_list.insert(block_list.begin() + i, new_block);
-        return i;
+        if (first < day) busy_runs[first] = day - 1;
+        if (day < last) busy_runs[day + 1] = last;
     }
-    
-    block_list.push_back(new_block);
-    return block_list.size() - 1;
+}
+
+// private
+int Database::free_day_from(int day, int step) const {
+    auto next = busy_runs.upper_bound(day);
+    if (next == busy_runs.begin()) return day;
+
+    auto run = std::prev(next);
+    if (run->second < day) return day;
+
+    return (step > 0)? run->second + 1 : run->first - 1;
+}
+
+// private
+void Database::update_gaps() {
+    // other day hours, every day is measured again
+    if (gap_day_start != config_ptr->day_start || gap_day_end != config_ptr->day_end) {
+        gap_day_start = config_ptr->day_start;
+        gap_day_end = config_ptr->day_end;
+
+        for (const auto& [day, summary] : summary_map) stale_gaps.insert(day);
+    }
+
+    for (int day : stale_gaps) {
+        auto old = day_gaps.find(day);
+        if (old != day_gaps.end()) {
+            std::set<int>& days = gap_days[old->second];
+            days.erase(day);
+            if (days.empty()) gap_days.erase(old->second);
+
+            day_gaps.erase(old);
+        }
+
+        if (summary_map.count(day) == 0) continue; // days without blocks are all free
+
+        time_t midnight = Calendar::midnight(day);
+        time_t gap = (gap_day_end > gap_day_start)?
+            longest_free_on_all(midnight + gap_day_start, midnight + gap_day_end) : 0;
+
+        day_gaps[day] = gap;
+        gap_days[gap].insert(day);
+    }
+
+    stale_gaps.clear();
+}
+
+// public
+const Database::day_summary& Database::get_day_summary(int day) {
+    static const day_summary empty = {};
+    expand_series(day, day);
+
+    auto it = summary_map.find(day);
+    return (it == summary_map.end())? empty : it->second;
 }
 
 // private
@@ -1,72 +1,238 @@
 #pragma once
 
 #include "Block.h"
+#include "Occupancy.h"
 
 #include <boost/algorithm/string.hpp>
 #include <ncursesw/ncurses.h>
 
 #include <random>
+#include <future>
+#include <exception>
+#include <thread>
+#include <limits>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <set>
 
 class Database {
 public:
     Database(Config* cfg_ptr);
 
-    void rename_block(time_t block_time, std::string new_title);
-    bool new_block_below(time_t block_time); // returns whether successful or not
-    bool new_block_above(time_t block_time); // returns whether successful or not
-    bool move_block_up(time_t block_time); // return success
-    bool move_block_down(time_t block_time); // return success
-    bool move_block_lateral(time_t block_time, int amt); // return success
-    void remove_block(time_t block_time);
+    // a block is found by its start and track, blocks on different tracks may overlap
+    struct block_key { time_t start; int track; };
 
-    bool extend_top_up(time_t block_time);
-    bool extend_top_down(time_t block_time);
-    bool extend_bottom_up(time_t block_time);
-    bool extend_bottom_down(time_t block_time);
+    void rename_block(time_t block_time, int track, std::string new_title);
+    // the new block goes on the same track, returns whether successful or not
+    bool new_block_below(time_t block_time, int track);
+    bool new_block_above(time_t block_time, int track);
+    // a block next to this one, as long as it (or shorter if the room runs out first)
+    // on the first track that is free where it starts, returns that track or -1
+    int new_block_beside(time_t block_time, int track);
+    // the edge moves below go up to this many minutes, but stop where they would collide
+    // (same result as that many single minute steps), and return the minutes moved
+    // SNAP_MINUTES moves the edge all the way to the neighbouring block or day bound
+    static const int SNAP_MINUTES = std::numeric_limits<int>::max();
+    int move_block_up(time_t block_time, int track, int minutes = 1);
+    int move_block_down(time_t block_time, int track, int minutes = 1);
+    bool move_block_lateral(time_t block_time, int track, int amt); // return success
+    void remove_block(time_t block_time, int track);
 
-    bool set_block_color(time_t block_time, std::string col);
-    void block_toggle_important(time_t block_time);
-    void block_toggle_collapsible(time_t block_time);
-    time_t edit_block_source(time_t block_time);
+    // ripple edits, the blocks after them on the track shift to make or fill the room
+    // a new block at this time (a block start or end, or day start), the blocks from here
+    // on move down by its length (shortened to what fits before day end, false if nothing)
+    bool ripple_insert(time_t block_time, int track);
+    void ripple_remove(time_t block_time, int track); // the blocks after it move up
+
+    int extend_top_up(time_t block_time, int track, int minutes = 1);
+    int extend_top_down(time_t block_time, int track, int minutes = 1);
+    int extend_bottom_up(time_t block_time, int track, int minutes = 1);
+    int extend_bottom_down(time_t block_time, int track, int minutes = 1);
+
+    bool set_block_color(time_t block_time, int track, std::string col);
+    void block_toggle_important(time_t block_time, int track);
+    void block_toggle_collapsible(time_t block_time, int track);
+    time_t edit_block_source(time_t block_time, int track);
 
     bool copy_block(Block& block, time_t target_start);
+    // saves a new block where it already starts, if that is inside the day and its track
+    // is free there, gives it a fresh id, returns whether it fit
+    bool add_block(Block& block);
+    // the same for many blocks at once, as one undo, with one pass over them to leave out
+    // the ones that don't fit, and their files written in parallel, returns how many fit
+    // if a file can't be written none are added (and the ones written are removed), throws
+    int add_blocks(std::vector<Block> blocks);
+    // the block with this id, for a series its next occurrence (or the series itself)
+    // returns false if there is none
+    bool find_block(int id, Block& block);
+
+    // edits of all these blocks at once, each is one undo
+    // moves and copies are checked for every block first, and only done if all of them fit
+    // (days and minutes are added to the start, the blocks keep their distance to each other)
+    bool shift_blocks(const std::vector<block_key>& keys, int days, int minutes);
+    bool copy_blocks(const std::vector<block_key>& keys, int days, int minutes);
+    // the same, with minutes of its own for each block (as many as keys)
+    bool copy_blocks(const std::vector<block_key>& keys, const std::vector<int>& minutes);
+    void set_blocks_color(const std::vector<block_key>& keys, std::string col);
+    void set_blocks_important(const std::vector<block_key>& keys, bool important);
+    void set_blocks_collapsible(const std::vector<block_key>& keys, bool collapsible);
+    void remove_blocks(const std::vector<block_key>& keys);
+
+    // start of the first stretch this long from start on that is free on every track
+    // and ends by limit (-1 if none)
+    time_t find_free_slot(time_t start, time_t duration, time_t limit);
+    // start of the last such stretch that ends by end and starts at limit or later
+    time_t find_free_slot_before(time_t end, time_t duration, time_t limit);
+    // start of the nearest such stretch inside the day hours from this time on (or back
+    // from it), -1 if there is none within a year
+    // the days are found thru the index of their longest free stretch, only one is searched
+    time_t find_free_slot_near(time_t from, time_t duration, bool backward);
+
+    enum en_match { MATCH_IMPORTANT, MATCH_COLOR, MATCH_TITLE }; // what a jump looks for
+    // the count-th block after the key (before it when backward) that is important, or has
+    // the color or the title of like (the last one if there are fewer), false if none
+    // the days with such blocks are sought in an ordered index, only those are looked at
+    bool find_match(block_key key, bool backward, en_match match, const Block& like,
+                    int count, Block& found);
+
+    // every change between these is undone and redone as one (they nest)
+    void begin_transaction();
+    void end_transaction();
 
     std::tuple<time_t, int> undo(); // returns the time and id of the changing block
     std::tuple<time_t, int> redo();
 
     void dump_info() const; // just for debug
     
-    // sorted list of blocks with start dates within 24h of given date
-    std::vector<Block> get_blocks_on_day(struct tm date) const;
+    // list of blocks starting on this civil day (see Calendar), sorted by start and track
+    // with the occurrences of recurring series, expanded when a day is first asked for
+    std::vector<Block> get_blocks_on_day(int day);
+    // the same for blocks starting between these two times (both included)
+    std::vector<Block> get_blocks_between(time_t first, time_t last);
+    // a range walk from a block on, for lists that go on for months: up to count blocks
+    // right after it in the list order (before it for the other one, nearest first)
+    // series are expanded a chunk of days at a time as far as it walks
+    // and a year without any blocks ends it, so what it costs is what it returns
+    // (a track of -1 puts the key before all blocks starting at that time)
+    std::vector<Block> get_blocks_after(block_key key, size_t count);
+    std::vector<Block> get_blocks_before(block_key key, size_t count);
+
+    struct day_summary { // totals of the blocks starting on a day
+        int busy_minutes;
+        int block_count;
+        int important_count;
+        int color_minutes[8]; // busy minutes by block color
+    };
+    // kept up to date as blocks change, so overviews never go thru the blocks themselves
+    // all zeros for days without blocks
+    const day_summary& get_day_summary(int day);
 
 private:
-    std::vector<Block> block_list; // the list of blocks (sorted by start date)
+    std::vector<Block> block_list; // the list of blocks (sorted by start date, then track)
     std::filesystem::path source_folder;
     std::string error_str;
     Config* config_ptr;
 
-    enum en_action_type { ACT_MODIFY, ACT_CREATE, ACT_DELETE };
+    // ACT_SERIES swaps whatever has the block's id (a series or a block) back to it
+    enum en_action_type { ACT_MODIFY, ACT_CREATE, ACT_DELETE, ACT_SERIES };
     struct action {
         en_action_type type; // the type of action
-        int index; // the index that was modified
+        int index; // the index that was modified (found again by id, expansions shift it)
         Block block; // the block as it was before the action
+        int batch; // actions of one transaction share this, 0 for lone actions
+        int day; // the day an ACT_SERIES change was made on, to show it there
     };
     std::vector<struct action> undo_vec;
     std::vector<struct action> redo_vec;
+    int current_batch; // the open transaction, or 0
+    int batch_count;
+    int transaction_depth;
+    void push_undo(action act); // stamps the open transaction on it
 
-    size_t index_at_time(time_t block_time);
-    size_t index_at_time_impl(time_t block_time, size_t range_start, size_t range_end);
-    int index_after_time(time_t block_time);
-    int index_before_time(time_t block_time);
+    std::unordered_map<int, day_summary> summary_map; // by civil day, only days with blocks
+
+    // the indexes jumps seek thru, kept with the summaries
+    // the days that have matching blocks, in order (day to how many blocks match)
+    std::map<int, int> important_days;
+    std::map<int, int> color_days[8]; // by block color
+    std::unordered_map<std::string, std::map<int, int>> title_days; // by title
+    static void count_day(std::map<int, int>& days, int day, int sign);
+    static bool matches(const Block& block, en_match match, const Block& like);
+    std::map<int, int>* match_days(en_match match, const Block& like); // nullptr if none
+
+    // runs of days with blocks (first day to last day, apart by at least a day)
+    // and the longest stretch in the day hours each of them has free on every track
+    std::map<int, int> busy_runs;
+    std::unordered_map<int, time_t> day_gaps; // by day
+    std::map<time_t, std::set<int>> gap_days; // the days by their longest free stretch
+    std::unordered_set<int> stale_gaps; // days whose blocks changed since they were measured
+    time_t gap_day_start, gap_day_end; // the day hours they were measured in
+    void set_busy(int day, bool busy); // keeps busy_runs
+    int free_day_from(int day, int step) const; // the nearest day without blocks that way
+    void update_gaps(); // measures the stale days again (after the occupancy caught up)
+    // the minutes taken by the blocks of each track, all placement checks go thru them
+    Occupancy occupancy[Block::TRACK_COUNT];
+    std::unordered_set<int> id_set; // ids of all blocks and series, for fresh ids and conflicts
+    std::mt19937 rng; // seeded once
+
+    // recurring blocks are kept once, as rules, and their occurrences are put in block_list
+    // (with the series id as group) the first time a range of days is asked for
+    std::unordered_map<int, Block> series_map; // by id
+    std::map<int, int> expanded_ranges; // first day to last day, merged, of what was expanded
+    static const int RANGE_CHUNK_DAYS = 31; // expanded at once by the range walks
+    void expand_series(int first_day, int last_day); // all series over the days not done yet
+    void expand_one(const Block& series, int first_day, int last_day);
+
+    // blocks with files are found by id, whether they are in block_list or a series
+    size_t index_of_id(int id) const; // in block_list, not counting occurrences
+    void put_file_block(Block block); // into block_list or the series (with its occurrences)
+    Block take_file_block(int id); // and back out
+    // edits to an occurrence only go to it, so it becomes a block of its own first
+    // and its series skips the day, returns the index of the new block
+    size_t own_block(size_t idx);
+    Block detach_occurrence(size_t idx); // own_block up to the new block, unsaved and not put in
+    void skip_occurrence(size_t idx); // the series leaves the day out, occurrence is erased
+    void add_to_summary(const Block& block, int sign); // sign -1 takes the block back out
+
+    size_t index_at_time(time_t block_time, int track); // throws if there is no such block
+    size_t index_after(const block_key& key) const; // of the first block after the key
+    static bool sorts_before(const Block& l, const Block& r); // the order of block_list
     void source_folder_integrity(std::filesystem::path val);
     int fresh_id();
-    size_t insert_block(Block new_block);
+
+    // the free slot searches without expanding series first
+    time_t free_slot_on_all(time_t start, time_t duration, time_t limit) const;
+    time_t free_slot_before_on_all(time_t end, time_t duration, time_t limit) const;
+    time_t longest_free_on_all(time_t start, time_t end) const;
+
+    int minutes_free_above(size_t idx); // room between the block and the one before
+    int minutes_free_below(size_t idx); // room between the block and the one after
+    int minutes_shrinkable(size_t idx); // how far it can shrink from either edge
+    bool fits_in_day(time_t start, time_t end) const; // between day start and day end
+    // these blocks moved by days and minutes, expands the series there
+    std::vector<Block> shifted_blocks(const std::vector<block_key>& keys,
+                                      int days, int minutes);
+    bool add_copies(std::vector<Block>& copies); // if all of them fit, as one undo
+
+    // moves these blocks (in order, one day) by delta, each file written once
+    void ripple_shift(const std::vector<block_key>& keys, time_t delta);
+    // moves the edges of a block by these deltas in one write
+    void shift_block_edges(size_t idx, time_t top_delta, time_t bottom_delta);
+    void push_edit_undo(int idx, const Block& block); // merged with a run of edits
+    size_t insert_block(const Block& new_block);
+    // sorted blocks that fit and have fresh ids (already in id_set), merged in at once
+    void insert_blocks(const std::vector<Block>& new_blocks);
+    void erase_block(size_t idx); // the only way blocks leave block_list
 
     // undoes an action from the first vec (popping it)
     // then adds its opposite to the other vector
     // returns the date time and id of the block affected
     std::tuple<time_t, int> undo_action(std::vector<struct action> *from,
                                         std::vector<struct action> *to);
+    // undo_action over the whole transaction at the back of from
+    std::tuple<time_t, int> undo_batch(std::vector<struct action> *from,
+                                       std::vector<struct action> *to);
 
 };
@@ -1,23 +1,36 @@
 #include "Day.h"
 
-Day::Day(Database *db_ptr, Config *cfg_ptr, time_t date_) {
-    date = *std::localtime(&date_);
+Day::Day(Database *db_ptr, Config *cfg_ptr, BoxCache *box_ptr, int day_) {
+    day = day_;
+    date = Calendar::to_tm(day);
 
     database_ptr = db_ptr;
     config_ptr = cfg_ptr;
+    box_cache_ptr = box_ptr;
 
-    last_height = 0;
+    last_height = last_width = 0;
+    content_height = clip_top = 0;
+    layout_key = 0;
     highlighted = false;
     focused_block_idx = 0;
 
-    day_start = 60*60*config_ptr->num({"time", "day_start_hour"})
-                 + 60*config_ptr->num({"time", "day_start_minute"});
+    draw_win = nullptr;
+    dirty = true;
+    cursor_minute = 0;
 
-    day_end = 60*60*config_ptr->num({"time", "day_end_hour"})
-               + 60*config_ptr->num({"time", "day_end_minute"});
+    day_start = config_ptr->day_start;
+    day_end = config_ptr->day_end;
 
-    date_format = config_ptr->str({"ui", "date_formats", "date_format"});
-    day_format = config_ptr->str({"ui", "date_formats", "day_format"});
+    date_format = config_ptr->date_format;
+    day_format = config_ptr->day_format;
+
+    background_color = config_ptr->colors.background;
+    cursor_color = config_ptr->colors.cursor;
+
+    top_line.day_str = get_day_str();
+    top_line.date_str = get_date_str();
+    top_line.expiry = 0; // compute the relative day on first draw
+    top_line.width = -1;
 
     error_str = "Day on " + std::to_string(date.tm_mday) + "."
                           + std::to_string(date.tm_mon) + "."
@@ -27,62 +40,99 @@ Day::Day(Database *db_ptr, Config *cfg_ptr, time_t date_) {
 }
 
 // public
-void Day::draw(int height, int width, int top_y, int left_x, bool focused) {
-    resize_heights(height - 1); // one line used for top_line (date str)
-    resize_width(width);
+void Day::draw(WINDOW* win, int height, int width, time_t time_per_line, int scroll,
+               bool focused) {
+    draw_win = win;
+    int top_y = 0, left_x = 0; // the window is placed where the day goes
+    clip_top = 0;
+
+    layout(height, width, time_per_line);
+    update_top_line(width);
 
     // draw the vertical rails bounding the day
-    attron(COLOR_PAIR(config_ptr->num({"ui", "colors", "background"})));
-    custom_box(height, width, top_y, left_x, BOX_BACKGROUND, focused);
-    attroff(COLOR_PAIR(config_ptr->num({"ui", "colors", "background"})));
+    wattron(draw_win, COLOR_PAIR(background_color));
+    custom_box(height, width, top_y, left_x, BoxCache::BOX_BACKGROUND, focused);
+    wattroff(draw_win, COLOR_PAIR(background_color));
 
-    draw_top_line(width, top_y, left_x, focused);
+    draw_top_line(top_y, left_x, focused);
 
     top_y++; // the blocks are drawn below
+    clip_top = top_y;
+    top_y -= scroll;
 
     for (size_t i = 0; i < ui_block_vec.size(); i++) {
-        struct ui_block uiblock = ui_block_vec[i];
+        const struct ui_block& uiblock = ui_block_vec[i];
+
+        // only the blocks that are (partly) in view
+        if (uiblock.top_y + uiblock.height <= scroll) continue;
+        if (uiblock.top_y >= scroll + height - 1) break;
 
-        draw_ui_block(uiblock, uiblock.height, width, top_y + uiblock.top_y, left_x,
-                      focused && focused_block_idx == i);
+        draw_ui_block(uiblock, uiblock.height, uiblock.width, top_y + uiblock.top_y,
+                      left_x + uiblock.left_x, focused && focused_block_idx == i);
     }
 
-    if (is_today()) draw_cursor(top_y, left_x + width, focused); // segfault
+    if (top_line.today) draw_cursor(top_y, left_x + width, focused);
+
+    dirty = false;
+}
+
+// public
+bool Day::needs_redraw(time_t now) const {
+    if (dirty) return true;
+    if (now >= top_line.expiry) return true; // relative labels change at midnight
+
+    return top_line.today && now / 60 != cursor_minute; // the cursor moved
+}
+
+// public
+void Day::mark_dirty() { dirty = true; }
+
+// public
+void Day::layout(int height, int width, time_t time_per_line) {
+    resize_heights(height - 1, time_per_line); // one line used for top_line (date str)
+    resize_width(width);
 }
 
 // private
-void Day::draw_top_line(int width, int top_y, int left_x, bool focused) {
-    std::string rel_str = get_relative_day();
-    std::string day_str = get_day_str();
-    std::string date_str = get_date_str();
-
-    int color;
-    if (rel_str == config_ptr->str({"ui", "relative_time", "today"}))
-        color = config_ptr->num({"ui", "colors", "today"});
-    else if (rel_str != "")
-        color = config_ptr->num({"ui", "colors", "relative"});
-    else
-        color = -1;
-
-    if (color != -1) {
-        attron(COLOR_PAIR(color));
-        if (focused) attron(A_BOLD);
+void Day::update_top_line(int width) {
+    time_t now = time(0);
+
+    if (now >= top_line.expiry) { // the date rolled over, so relative labels changed
+        top_line.rel_str = get_relative_day();
+        top_line.today = is_today();
+
+        if (top_line.today)
+            top_line.color = config_ptr->colors.today;
+        else if (top_line.rel_str != "")
+            top_line.color = config_ptr->colors.relative;
+        else
+            top_line.color = -1;
+
+        top_line.expiry = Calendar::midnight(Calendar::today() + 1);
+
+        top_line.width = -1; // text has to be recomposed
     }
-    
-    std::string ch_spacer = " ";
-    std::string spacer = "";
+
+    if (width == top_line.width) return;
+    top_line.width = width;
+
+    const std::string& rel_str = top_line.rel_str;
+    const std::string& day_str = top_line.day_str;
+    const std::string& date_str = top_line.date_str;
+
+    top_line.x = 0;
 
     if (rel_str == "") {
         int spacer_2 = width - (day_str.size() + date_str.size());
         int spacer_1 = width - date_str.size();
 
         if (spacer_2 > 0) {
-            for (int i = 0; i < spacer_2; i++) spacer += ch_spacer;
-            mvprintw(top_y, left_x, "%s", (day_str + spacer + date_str).c_str());
+            top_line.text = day_str + std::string(spacer_2, ' ') + date_str;
         } else if (spacer_1 > 0) {
-            mvprintw(top_y, left_x + spacer_1, "%s", date_str.c_str());
+            top_line.text = date_str;
+            top_line.x = spacer_1;
         } else {
-            mvprintw(top_y, left_x, "%s", date_str.substr(0, width).c_str());
+            top_line.text = date_str.substr(0, width);
         }
     } else {
         int spacer_3 = width - (rel_str.size() + day_str.size() + 1 + date_str.size());
@@ -90,89 +140,96 @@ void Day::draw_top_line(int width, int top_y, int left_x, bool focused) {
         int spacer_1 = width - date_str.size();
 
         if (spacer_3 > 0) {
-            for (int i = 0; i < spacer_3; i++) spacer += ch_spacer;
-            mvprintw(top_y, left_x, "%s", (rel_str + spacer + day_str + " " + date_str).c_str());
+            top_line.text = rel_str + std::string(spacer_3, ' ') + day_str + " " + date_str;
         } else if (spacer_2 > 0) {
-            for (int i = 0; i < spacer_2; i++) spacer += ch_spacer;
-            mvprintw(top_y, left_x, "%s", (rel_str + spacer + date_str).c_str());
+            top_line.text = rel_str + std::string(spacer_2, ' ') + date_str;
         } else if (spacer_1 > 0) {
-            mvprintw(top_y, left_x + spacer_1, "%s", date_str.c_str());
+            top_line.text = date_str;
+            top_line.x = spacer_1;
         } else {
-            mvprintw(top_y, left_x, "%s", date_str.substr(0, width).c_str());
+            top_line.text = date_str.substr(0, width);
         }
     }
+}
+
+// private
+void Day::draw_top_line(int top_y, int left_x, bool focused) {
+    if (top_line.color != -1) {
+        wattron(draw_win, COLOR_PAIR(top_line.color));
+        if (focused) wattron(draw_win, A_BOLD);
+    }
 
-    if (color != -1) {
-        attroff(COLOR_PAIR(color));
-        if (focused) attroff(A_BOLD);
+    mvwaddstr(draw_win, top_y, left_x + top_line.x, top_line.text.c_str());
+
+    if (top_line.color != -1) {
+        wattroff(draw_win, COLOR_PAIR(top_line.color));
+        if (focused) wattroff(draw_win, A_BOLD);
     }
 }
 
 // private
 void Day::draw_cursor(int top_y, int x_pos, bool focused) {
-    float f_line = get_line_at_time(time(0)); // segfault
+    time_t now = time(0);
+    cursor_minute = now / 60;
+
+    float f_line = line_map.line_at_time(now);
     int i_line = (int) f_line;
     int dec_3 = (int) (3 * (f_line - i_line));
+    if (top_y + i_line < clip_top) return; // scrolled out of view
 
-    std::string character = "X";
+    const char* character = "X";
     if      (dec_3 == 0) character = "🬂";
     else if (dec_3 == 1) character = "🬋";
     else if (dec_3 == 2) character = "🬭";
 
-    int color = config_ptr->num({"ui", "colors", "cursor"});
-
-    if (color == -1) {
-        color = config_ptr->num({"ui", "colors", "today"});
-    }
-
-    attron(COLOR_PAIR(color));
-    mvprintw(top_y + i_line, x_pos, "%s", character.c_str());
-    attroff(COLOR_PAIR(color));
+    wattron(draw_win, COLOR_PAIR(cursor_color));
+    mvwaddstr(draw_win, top_y + i_line, x_pos, character);
+    wattroff(draw_win, COLOR_PAIR(cursor_color));
 }
 
 // private
-void Day::draw_ui_block(struct ui_block uiblock,
+void Day::draw_ui_block(const struct ui_block& uiblock,
                         int height, int width, int top_y, int left_x, bool focused) {
-    if (uiblock.block.get_collapsible()) {
+    if (uiblock.collapsible) {
         width -= 2;
         left_x++;
     }
 
-    int color;
-    color = uiblock.block.get_color();
-
-    attron(COLOR_PAIR(color));
-    // if (focused) attron(A_BOLD);
+    wattron(draw_win, COLOR_PAIR(uiblock.color));
+    // if (focused) wattron(draw_win, A_BOLD);
+    if (uiblock.highlighted && !focused) wattron(draw_win, A_REVERSE); // selected
 
-    custom_box(height, width, top_y, left_x,
-               uiblock.block.get_important()? BOX_IMPORTANT : BOX_NORMAL, focused);
+    custom_box(height, width, top_y, left_x, uiblock.box_type, focused);
 
-    std::string hour = uiblock.block.get_t_start_hour_str();
-    mvprintw(top_y, left_x + 1, "%s", hour.c_str());
+    put_str(top_y, left_x + 1, uiblock.start_str);
 
     // if there is not a block right below, specify the ending time
-    if (!uiblock.bottom_adjacent) {
-        hour = uiblock.block.get_t_end_hour_str();
+    // (on the top line too for short blocks, as long as the two fit side by side)
+    bool end_fits = height > 2
+                 || (int) (uiblock.start_str.size() + uiblock.end_str.size()) + 2 < width;
+    if (!uiblock.bottom_adjacent && end_fits) {
         int draw_height = (height == 2)? 0 : height - 1;
         draw_height += top_y;
 
-        mvprintw(draw_height, left_x + width - hour.size() - 1, "%s", hour.c_str());
+        put_str(draw_height, left_x + width - uiblock.end_str.size() - 1, uiblock.end_str);
     }
 
     draw_ui_block_title(uiblock, height - 2, left_x + 2, top_y + 1);
 
-    attroff(COLOR_PAIR(color));
-    // if (focused) attroff(A_BOLD);
+    wattroff(draw_win, COLOR_PAIR(uiblock.color));
+    // if (focused) wattroff(draw_win, A_BOLD);
+    wattroff(draw_win, A_REVERSE);
 }
 
 // private
-void Day::draw_ui_block_title(struct ui_block uiblock, int height, int left_x, int top_y) {
-    std::vector<std::string> title_vec = uiblock.title_vec;
+void Day::draw_ui_block_title(const struct ui_block& uiblock,
+                              int height, int left_x, int top_y) {
+    const std::vector<std::string>& title_vec = uiblock.title_vec;
 
     if (height == 0) {
-        if (uiblock.block.get_collapsible()) left_x--;
+        if (uiblock.collapsible) left_x--;
 
-        mvprintw(top_y, left_x, "%s", title_vec[0].c_str());
+        put_str(top_y, left_x, title_vec[0]);
     } else {
         int start_line = (height - title_vec.size()) / 2;
         if (title_vec.size() >= height) start_line = 0;
@@ -180,7 +237,7 @@ void Day::draw_ui_block_title(struct ui_block uiblock, int height, int left_x, i
         for (int i = 0; i < title_vec.size(); i++) {
             if (start_line + i == height) break;
 
-            mvprintw(top_y + start_line + i, left_x, "%s", title_vec[i].c_str());
+            put_str(top_y + start_line + i, left_x, title_vec[i]);
         }
     }
 }
@@ -201,8 +258,16 @@ void Day::populate_vector() {
     ui_block_vec.clear();
 
     int i = 0;
-    for (Block block : database_ptr->get_blocks_on_day(date)) { i++;
-        struct ui_block new_ui_block = { block, false, false, 0, 0, {} };
+    for (Block block : database_ptr->get_blocks_on_day(day)) { i++;
+        struct ui_block new_ui_block = { block, false, false, 0, 0, 0, 0, 0, 0, {} };
+
+        // everything drawn for the block that only changes when the block does
+        new_ui_block.start_str = block.get_t_start_hour_str();
+        new_ui_block.end_str = block.get_t_end_hour_str();
+        new_ui_block.color = block.get_color();
+        new_ui_block.box_type = block.get_important()? BoxCache::BOX_IMPORTANT
+                                                      : BoxCache::BOX_NORMAL;
+        new_ui_block.collapsible = block.get_collapsible();
 
         // if this block's id is in the focused list
         if (std::find(highlighted_ids.begin(), highlighted_ids.end(), block.get_id())
@@ -210,84 +275,178 @@ void Day::populate_vector() {
 
         if (block.get_id() == focused_id) focused_block_idx = i;
 
-        // sets the block before's bottom adjecency
-        if (ui_block_vec.size() != 0) {
-            struct ui_block &last = ui_block_vec.back();
-
-            last.bottom_adjacent =
-                last.block.get_time_t_start() + last.block.get_duration()
-                == block.get_time_t_start();
-        }
-
         ui_block_vec.push_back(new_ui_block);
     }
 
+    assign_columns();
     set_focus_inbounds();
 }
 
+// private
+void Day::assign_columns() {
+    cluster_vec.clear();
+
+    // the blocks still going on by when they end (soonest first) with their columns
+    // and the columns given back by the ones that ended, lowest first
+    typedef std::pair<time_t, int> active_block;
+    std::priority_queue<active_block, std::vector<active_block>, std::greater<active_block>>
+        active;
+    std::priority_queue<int, std::vector<int>, std::greater<int>> free_columns;
+    std::vector<size_t> last_in_column; // the block that was last put in each column
+    std::vector<int> column_depth; // blocks in each column of the current cluster
+
+    for (size_t i = 0; i < ui_block_vec.size(); i++) {
+        struct ui_block& uiblock = ui_block_vec[i];
+        time_t start = uiblock.block.get_time_t_start();
+        time_t end = uiblock.block.get_time_t_end();
+
+        while (!active.empty() && active.top().first <= start) {
+            free_columns.push(active.top().second);
+            active.pop();
+        }
+
+        if (active.empty()) { // nothing overlaps it, it starts a new cluster
+            free_columns = {};
+            column_depth.clear();
+            cluster_vec.push_back({ i, i, start, end, 0, 0,
+                                    uiblock.block.get_collapsible(), 0, 0 });
+        }
+
+        struct cluster& cl = cluster_vec.back();
+
+        if (free_columns.empty()) {
+            uiblock.column = cl.column_count++;
+            column_depth.push_back(0);
+            if ((int) last_in_column.size() < cl.column_count) last_in_column.push_back(i);
+        } else {
+            uiblock.column = free_columns.top();
+            free_columns.pop();
+        }
+
+        uiblock.stacked = column_depth[uiblock.column]++;
+        cl.depth = std::max(cl.depth, column_depth[uiblock.column]);
+
+        // the end time isn't shown if the block below it in its column starts then
+        struct ui_block& above = ui_block_vec[last_in_column[uiblock.column]];
+        if (&above != &uiblock)
+            above.bottom_adjacent = above.block.get_time_t_end() == start;
+        last_in_column[uiblock.column] = i;
+
+        active.push({ end, uiblock.column });
+
+        cl.last = i;
+        cl.end = std::max(cl.end, end);
+        cl.collapsible = cl.collapsible && cl.first == i;
+    }
+}
+
 // private
 void Day::resize_width(int total_width) {
     if (total_width == last_width) return;
     last_width = total_width;
+    dirty = true;
 
-    int text_width = total_width - 4;
+    // the columns of a cluster split the width, the last one takes what is left over
+    for (const struct cluster& cl : cluster_vec) {
+        int column_width = total_width / cl.column_count;
 
-    for (struct ui_block& uiblock : ui_block_vec) {
-        uiblock.title_vec.clear();
-
-        std::string title = uiblock.block.get_title();
+        for (size_t i = cl.first; i <= cl.last; i++) {
+            struct ui_block& uiblock = ui_block_vec[i];
 
-        float f_linecount = title.size();
-        f_linecount /= text_width;
-        int linecount = (int) std::ceil(f_linecount);
+            uiblock.left_x = uiblock.column * column_width;
+            uiblock.width = (uiblock.column == cl.column_count - 1)?
+                total_width - uiblock.left_x : column_width;
 
-        for (int i = 0; i < linecount; i++)
-            uiblock.title_vec.push_back(title.substr(i*text_width, text_width));
+            // wraps are shared between days, so this is usually just a lookup
+            uiblock.title_vec = Wrap::wrap(uiblock.block.get_title(), uiblock.width - 4);
+        }
     }
 }
 
 // private
-void Day::resize_heights(int total_height) {
-    if (total_height == last_height) return;
+void Day::resize_heights(int total_height, time_t time_per_line) {
     last_height = total_height;
+
+    // fitting the day depends on the height, a fixed zoom level doesn't
+    time_t key = (time_per_line == 0)? -total_height : time_per_line;
+    if (key == layout_key) return;
+    layout_key = key;
+    dirty = true;
+
+    auto it = layout_cache.find(key);
+    if (it != layout_cache.end()) { // laid out at this zoom before
+        const layout_model& model = it->second;
+
+        for (size_t i = 0; i < ui_block_vec.size(); i++) {
+            ui_block_vec[i].top_y = model.rows[i].first;
+            ui_block_vec[i].height = model.rows[i].second;
+        }
+
+        line_map = model.line_map;
+        content_height = model.content_height;
+        last_time_per_line = model.time_per_line;
+        return;
+    }
+
+    place_blocks(total_height, time_per_line);
+    build_line_map();
+
+    layout_model& model = layout_cache[key];
+    model.rows.reserve(ui_block_vec.size());
+    for (const struct ui_block& uiblock : ui_block_vec)
+        model.rows.push_back({ uiblock.top_y, uiblock.height });
+
+    model.line_map = line_map;
+    model.content_height = content_height;
+    model.time_per_line = last_time_per_line;
+}
+
+// private
+void Day::place_blocks(int total_height, time_t time_per_line) {
     time_t total_time = day_end - day_start;
 
     // account for collapsed tasks not requiring space for their time
-    for (struct ui_block uiblock : ui_block_vec)
-        if (uiblock.block.get_collapsible()) total_time -= uiblock.block.get_duration();
+    for (const struct cluster& cl : cluster_vec)
+        if (cl.collapsible) total_time -= cl.end - cl.start;
 
-    // each block has an upper and lower border
+    // each block has an upper and lower border, blocks side by side share the lines
     // so only the remaining space can be used to express time length
-    int total_lines = total_height - 2 * ui_block_vec.size();
+    int border_lines = 0;
+    for (const struct cluster& cl : cluster_vec) border_lines += 2 * cl.depth;
+
+    if (time_per_line == 0) { // the amount of time each line represents
+        float f_tpl = total_time;
+        f_tpl /= total_height - border_lines;
+        time_per_line = (time_t) (f_tpl + 0.5);
+    } else { // zoomed in, the day is as tall as it needs to be
+        total_height = (total_time + time_per_line - 1) / time_per_line + border_lines;
+    }
 
-    // the amount of time each line represents
-    float f_tpl = total_time;
-    f_tpl /= total_lines;
-    time_t time_per_line = (time_t) (f_tpl + 0.5);
     last_time_per_line = time_per_line;
+    content_height = total_height;
 
-    // calculate and assign height and position to blocks
-    time_t last_end_time = std::mktime(&date) + day_start;
+    // calculate and assign height and position to clusters
+    time_t last_end_time = get_date_time() + day_start;
     int last_end_line = 0;
-    for (struct ui_block& uiblock : ui_block_vec) {
-        float f_top_y = uiblock.block.get_time_t_start() - last_end_time;
+    for (struct cluster& cl : cluster_vec) {
+        float f_top_y = cl.start - last_end_time;
         f_top_y /= time_per_line;
 
-        uiblock.top_y = (int) (last_end_line + f_top_y + 0.5);
+        cl.top_y = (int) (last_end_line + f_top_y + 0.5);
 
-        if (uiblock.block.get_collapsible()) {
-            uiblock.height = 2;
+        if (cl.collapsible) {
+            cl.height = 2;
         } else {
-            float f_height = uiblock.block.get_duration();
+            float f_height = cl.end - cl.start;
             f_height /= time_per_line;
-            uiblock.height = (int) (2 + f_height + 0.5);
+            cl.height = (int) (2 * cl.depth + f_height + 0.5);
         }
 
-        last_end_line = uiblock.top_y + uiblock.height;
-        last_end_time = uiblock.block.get_time_t_start() + uiblock.block.get_duration();
+        last_end_line = cl.top_y + cl.height;
+        last_end_time = cl.end;
     }
 
-    time_t extra_time = mktime(&date) + day_end - last_end_time; // from last task to eod
+    time_t extra_time = get_date_time() + day_end - last_end_time; // from last task to eod
     if (extra_time > 0) {
         float extra_lines = extra_time;
         extra_lines /= time_per_line;
@@ -301,17 +460,20 @@ void Day::resize_heights(int total_height) {
     // the code below is in fact necessary, so we take a performance hit to correct errs
     // return; // TODO if any errors crop up this is prolly related lmfao
 
-    if (empty_rows < 0
-     && ui_block_vec.back().top_y + ui_block_vec.back().height <= total_height) return;
+    if (empty_rows < 0 && !cluster_vec.empty()
+     && cluster_vec.back().top_y + cluster_vec.back().height <= total_height) {
+        place_in_clusters();
+        return;
+    }
 
     // if there are empty rows or overflow, account for it
     // in theory this should never happen but just in case
     // multiple passes, so that extreme measures only take if necessary
     for (int pass = 0; pass <= 4; pass++) {
-        for (size_t i = 0; i < ui_block_vec.size(); i++) {
-            struct ui_block& uiblock = ui_block_vec[i];
+        for (size_t i = 0; i < cluster_vec.size(); i++) {
+            struct cluster& cl = cluster_vec[i];
             int prev_bottom_y = bottom_y;
-            bottom_y = uiblock.top_y + uiblock.height;
+            bottom_y = cl.top_y + cl.height;
 
             if (empty_rows == 0) break; // job done - this will usually be hit first iter
             
@@ -319,21 +481,21 @@ void Day::resize_heights(int total_height) {
             
             if (pass == 4) {
                 adjustment = empty_rows;
-                int adj_bound = 2 - uiblock.height;
+                int adj_bound = 2 * cl.depth - cl.height;
                 if (adjustment < adj_bound) adjustment = adj_bound;
                 empty_rows -= adjustment;
 
-                uiblock.height += adjustment;
-                for (size_t j = i+1; j < ui_block_vec.size(); j++)
-                    ui_block_vec[j].top_y += adjustment;
+                cl.height += adjustment;
+                for (size_t j = i+1; j < cluster_vec.size(); j++)
+                    cluster_vec[j].top_y += adjustment;
 
                 continue;
             }
 
             // find blocks with gap before them
-            if (prev_bottom_y == uiblock.top_y) continue;
+            if (prev_bottom_y == cl.top_y) continue;
 
-            int gap_size = uiblock.top_y - prev_bottom_y;
+            int gap_size = cl.top_y - prev_bottom_y;
             // if on the first pass, only use gaps bigger than s
             if (gap_size <= 2 - pass) continue;
 
@@ -345,72 +507,56 @@ void Day::resize_heights(int total_height) {
             if (-adjustment > gap_size) adjustment = -gap_size;
 
             empty_rows -= adjustment;
-            for (size_t j = i; j < ui_block_vec.size(); j++)
-                ui_block_vec[j].top_y += adjustment;
+            for (size_t j = i; j < cluster_vec.size(); j++)
+                cluster_vec[j].top_y += adjustment;
         }
     }
+
+    place_in_clusters();
 }
 
 // private
-float Day::get_line_at_time(time_t absolute_time) { // assume the time is today
-    absolute_time -= (absolute_time % 60); // remove seconds
-    // first find what task it falls into
-    float start_line = 0, height = 0;
-    time_t start_time = 0, duration = 0;
-
-    int previous_end_line;
-    time_t previous_end_time = get_date_time() + day_start;
-    for (struct ui_block uiblock: ui_block_vec) { Block block = uiblock.block;
-
-        // first check range between last block and start of this one
-        if (absolute_time > previous_end_time &&
-            absolute_time < block.get_time_t_start()) {
-
-            start_line = previous_end_line - 0.33333;
-            height = uiblock.top_y - previous_end_line + 0.66666;
-            start_time = previous_end_time;
-            duration = block.get_time_t_start() - previous_end_time;
-
-            break;
-        // now check the range of this block
-        } else if (absolute_time >= block.get_time_t_start() &&
-                   absolute_time <= block.get_time_t_start() + block.get_duration()) {
-
-            start_line = uiblock.top_y + 0.5;
-            height = uiblock.height - 1;
-            start_time = block.get_time_t_start();
-            duration = block.get_duration();
-
-            break;
-        }
+void Day::place_in_clusters() {
+    for (const struct cluster& cl : cluster_vec) {
+        // the lines left after the borders stand for its time
+        float lines_per_second = cl.height - 2 * cl.depth;
+        lines_per_second /= std::max<time_t>(cl.end - cl.start, 1);
 
-        previous_end_line = uiblock.top_y + uiblock.height;
-        previous_end_time = block.get_time_t_start() + block.get_duration();
-    }
+        for (size_t i = cl.first; i <= cl.last; i++) {
+            struct ui_block& uiblock = ui_block_vec[i];
 
-    if (height == 0) { // time is below the last block
-        if (ui_block_vec.empty()) {
-            start_line = 0;
-            height = (float) last_height - 0.33333;
-            start_time = previous_end_time;
-            duration = day_end - day_start;
-        } else {
-            struct ui_block uiblock = ui_block_vec.back(); // segfault
+            if (cl.first == cl.last) { // alone, it is the cluster
+                uiblock.top_y = cl.top_y;
+                uiblock.height = cl.height;
+                continue;
+            }
 
-            start_line = uiblock.top_y + uiblock.height - 0.33333;
-            height = last_height - previous_end_line + 0.33333;
-            start_time = previous_end_time;
-            duration = std::mktime(&date) + day_end - previous_end_time;
+            // below the borders of the blocks above it in its column
+            float f_top = uiblock.block.get_time_t_start() - cl.start;
+            float f_bottom = uiblock.block.get_time_t_end() - cl.start;
+            int top = cl.top_y + 2 * uiblock.stacked + (int) (f_top * lines_per_second + 0.5);
+            int bottom = cl.top_y + 2 * (uiblock.stacked + 1)
+                       + (int) (f_bottom * lines_per_second + 0.5);
+
+            // never past the bottom of the cluster, and never less than its borders
+            uiblock.top_y = std::min(top, cl.top_y + cl.height - 2);
+            uiblock.height = std::max(std::min(bottom, cl.top_y + cl.height) - uiblock.top_y, 2);
+            if (uiblock.block.get_collapsible()) uiblock.height = 2;
         }
     }
+}
+
+// private
+void Day::build_line_map() {
+    // the clusters don't overlap, so they are what times map onto
+    std::vector<LineMap::span> spans;
+    spans.reserve(cluster_vec.size());
 
-    // ret = start_line + height * (absolute_time - start_time) / duration
-    float ret = height;
-    ret /= duration;
-    ret *= absolute_time - start_time;
-    ret += start_line;
+    for (const struct cluster& cl : cluster_vec)
+        spans.push_back({ cl.start, cl.end, cl.top_y, cl.height });
 
-    return ret;
+    time_t date_time = get_date_time();
+    line_map.build(spans, date_time + day_start, date_time + day_end, content_height);
 }
 
 // public
@@ -483,11 +629,37 @@ bool Day::set_focus_id(int id) {
     return false;
 }
 
+// public
+bool Day::set_focus_start(time_t start, int track) {
+    for (size_t i = 0; i < ui_block_vec.size(); i++) {
+        const Block& block = ui_block_vec[i].block;
+
+        if (block.get_time_t_start() == start && block.get_track() == track) {
+            set_focus(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// public
+void Day::set_selection(time_t first, time_t last) {
+    for (struct ui_block& uiblock : ui_block_vec) {
+        time_t start = uiblock.block.get_time_t_start();
+        bool selected = start >= first && start <= last;
+
+        if (uiblock.highlighted != selected) dirty = true; // only redrawn if it changed
+        uiblock.highlighted = selected;
+    }
+}
+
 // public
 int Day::get_focus() { return focused_block_idx; }
 
 // private
 void Day::set_focus_inbounds() {
+    dirty = true; // every focus change passes through here
     if (focused_block_idx <= 0)
         focused_block_idx = 0;
 
@@ -500,15 +672,19 @@ void Day::set_highlighted(bool new_highlighted) { highlighted = new_highlighted;
 
 // public
 void Day::integrity_check() const {
-    int previous_end_line = 0;
+    // blocks only share lines with the ones in other columns of their cluster
+    std::vector<int> previous_end_line;
     for (struct ui_block uiblock : ui_block_vec) {
-        if (uiblock.top_y < previous_end_line) {
+        if ((int) previous_end_line.size() <= uiblock.column)
+            previous_end_line.resize(uiblock.column + 1, 0);
+
+        if (uiblock.top_y < previous_end_line[uiblock.column]) {
             uiblock.block.dump_info();
             throw std::runtime_error(error_str + "block " + uiblock.block.get_title()
                                      + " overlaps with previous block");
         }
 
-        previous_end_line = uiblock.top_y + uiblock.height;
+        previous_end_line[uiblock.column] = uiblock.top_y + uiblock.height;
     }
 
     if (date.tm_hour != 0 || date.tm_min != 0 || date.tm_sec != 0)
@@ -516,98 +692,52 @@ void Day::integrity_check() const {
 }
 
 // private
-bool Day::is_today() const {
-    // struct tm date_cp = date;
-    time_t now = time(0);
-    struct tm today = *localtime(&now);
-    // today.tm_hour = 0; today.tm_min = 0; today.tm_sec = 0;
-
-    return date.tm_year == today.tm_year
-        && date.tm_mon == today.tm_mon
-        && date.tm_mday == today.tm_mday;
-}
+bool Day::is_today() const { return day == Calendar::today(); }
 
 // private
 std::string Day::get_relative_day() const {
-    time_t now = time(0);
-    struct tm today = *localtime(&now);
-    today.tm_hour = 0; today.tm_min = 0; today.tm_sec = 0;
-    struct tm date_cp = date;
-
-    time_t today_t = std::mktime(&today);
-    time_t date_t = std::mktime(&date_cp);
-    time_t day = 24*60*60;
-
-    if (date_t == today_t - day)
-        return config_ptr->str({"ui", "relative_time", "yesterday"});
-    else if (date_t == today_t)
-        return config_ptr->str({"ui", "relative_time", "today"});
-    else if (date_t == today_t + day)
-        return config_ptr->str({"ui", "relative_time", "tomorrow"});
-    else if (date_t == today_t + 7*day)
-        return config_ptr->str({"ui", "relative_time", "next_week"});
-    else if (date_t == today_t - 7*day)
-        return config_ptr->str({"ui", "relative_time", "last_week"});
-
-    else if (date.tm_mday == today.tm_mday && date.tm_year == today.tm_year) {
-        if (date.tm_mon == today.tm_mon + 1)
-            return config_ptr->str({"ui", "relative_time", "next_month"});
-        else if (date.tm_mon == today.tm_mon - 1)
-            return config_ptr->str({"ui", "relative_time", "last_month"});
-        else return "";
-    } else if (date.tm_mday == today.tm_mday && date.tm_mon == today.tm_mon) {
-        if (date.tm_year == today.tm_year + 1)
-            return config_ptr->str({"ui", "relative_time", "next_year"});
-        else if (date.tm_year == today.tm_year - 1)
-            return config_ptr->str({"ui", "relative_time", "last_year"});
-        else return "";
-    } else return "";
+    int today = Calendar::today();
+    const std::string* names = config_ptr->relative_names;
+
+    if (day == today - 1) return names[Config::REL_YESTERDAY];
+    else if (day == today) return names[Config::REL_TODAY];
+    else if (day == today + 1) return names[Config::REL_TOMORROW];
+    else if (day == today + 7) return names[Config::REL_NEXT_WEEK];
+    else if (day == today - 7) return names[Config::REL_LAST_WEEK];
+
+    // the same day of the month, a month or a year away
+    if (Calendar::civil_from_days(day).day != Calendar::civil_from_days(today).day) return "";
+
+    switch (Calendar::months_between(today, day)) {
+        case 1:   return names[Config::REL_NEXT_MONTH];
+        case -1:  return names[Config::REL_LAST_MONTH];
+        case 12:  return names[Config::REL_NEXT_YEAR];
+        case -12: return names[Config::REL_LAST_YEAR];
+        default:  return "";
+    }
 }
 
 // private
-void Day::custom_box(int height, int width, int top_y, int left_x, en_box_type type, bool filled) {
-    std::string type_id;
-
-    if (type == BOX_NORMAL) type_id = "normal";
-    else if (type == BOX_IMPORTANT) type_id = "important";
-    else if (type == BOX_BACKGROUND) type_id = "background";
-
-    std::string tl, tr, bl, br, hz, vr, fill;
-    tl = config_ptr->str({"ui", "boxdrawing", type_id+"_tl"});
-    tr = config_ptr->str({"ui", "boxdrawing", type_id+"_tr"});
-    bl = config_ptr->str({"ui", "boxdrawing", type_id+"_bl"});
-    br = config_ptr->str({"ui", "boxdrawing", type_id+"_br"});
-    hz = config_ptr->str({"ui", "boxdrawing", type_id+"_hz"});
-    vr = config_ptr->str({"ui", "boxdrawing", type_id+"_vr"});
-    fill = filled ? config_ptr->str({"ui", "boxdrawing", "highlight_fill"})
-                  : config_ptr->str({"ui", "boxdrawing", type_id+"_fill"});
-
-    if (type == BOX_BACKGROUND && filled)
-        fill = " ";
-    else if (filled)
-        tl = tr = bl = br = hz = vr = fill;
-
-    std::string horizontal = "";
-    for (int i = 0; i < width - 2; i++) horizontal += hz;
-    std::string top = tl + horizontal + tr;
-    std::string bottom = bl + horizontal + br;
-
-    mvprintw(top_y, left_x, "%s", top.c_str());
-
-    for (int i = 1; i < height - 1; i++) {
-        std::string line = vr;
-        for (int j = 1; j < width - 1; j++) {
-            if (type == BOX_BACKGROUND && filled && (i+j)%2 == 0)
-                line += config_ptr->str({"ui", "boxdrawing", "background_focus_fill"});
-            else
-                line += fill;
-        }
-        line += vr;
+void Day::custom_box(int height, int width, int top_y, int left_x,
+                     BoxCache::en_box_type type, bool filled) {
+    const BoxCache::box_rows& rows = box_cache_ptr->get_rows(type, filled, width);
 
-        mvprintw(top_y + i, left_x, "%s", line.c_str());
-    }
+    put_str(top_y, left_x, rows.top);
+
+    // only the rows inside the window, long blocks can reach far past it when zoomed
+    int first_row = std::max(1, clip_top - top_y);
+    int last_row = std::min(height - 1, getmaxy(draw_win) - top_y);
+
+    for (int i = first_row; i < last_row; i++)
+        put_str(top_y + i, left_x, rows.middle[i % 2]);
 
-    mvprintw(top_y + height - 1, left_x, "%s", bottom.c_str());
+    put_str(top_y + height - 1, left_x, rows.bottom);
+}
+
+// private
+void Day::put_str(int y, int x, const std::string& str) {
+    if (y < clip_top) return;
+    mvwaddnstr(draw_win, y, x, str.c_str(), str.size());
 }
 
 // public
@@ -618,55 +748,19 @@ int Day::get_focus_line() {
          + ui_block_vec[focused_block_idx].height / 2;
 }
 
+// public
+int Day::get_content_height() const { return content_height; }
+
 // public
 void Day::set_focus_time(time_t absolute_time) {
-    set_focus_line(int(get_line_at_time(absolute_time) + 0.5));
+    set_focus_line(int(line_map.line_at_time(absolute_time) + 0.5));
 }
 
 // public
 void Day::set_focus_line(int line) {
-    if (ui_block_vec.empty()) {
-        focused_block_idx = 0;
-        return;
-    }
-
-    // check if task is above first task or after last task
-    if (line < ui_block_vec.front().top_y) {
-        focused_block_idx = 0;
-        return;
-    } else if (line > ui_block_vec.back().top_y) {
-        focused_block_idx = ui_block_vec.size() - 1;
-        return;
-    }
-
-    int previous_end_line = 0;
-
-    for (size_t i = 0; i < ui_block_vec.size(); i++) {
-        struct ui_block uiblock = ui_block_vec[i];
-
-        // check if the line is in this block
-        if (line >= uiblock.top_y && line <= uiblock.top_y + uiblock.height - 1) {
-            focused_block_idx = i;
-        // check if line is in the gap above this block
-        } else if (line >= previous_end_line && line < uiblock.top_y) {
-            int gap_height = uiblock.top_y - previous_end_line; // amount of lines
-            int gap_line = line - previous_end_line; // starting at 0
-
-            float f_gap_pos = gap_line + 1; // so that middle line is treated downwards
-            f_gap_pos /= gap_height;
-
-            if (f_gap_pos <= 0.5 + 0.00001) {
-                focused_block_idx = i - 1;
-            } else {
-                focused_block_idx = i;
-            }
-        } else {
-            previous_end_line = uiblock.top_y + uiblock.height;
-            continue;
-        }
-
-        return;
-    }
+    int idx = line_map.index_at_line(line); // of the cluster, its first block gets the focus
+    focused_block_idx = (idx == -1)? 0 : cluster_vec[idx].first;
+    dirty = true;
 }
 
 // public
@@ -678,16 +772,13 @@ int Day::get_focus_time_start() {
 }
 
 // public
-bool Day::is_date_equal(struct tm other) const {
-    struct tm cp = date;
-    return std::mktime(&cp) == std::mktime(&other);
-}
+bool Day::is_date_equal(struct tm other) const { return day == Calendar::day_of(other); }
 
 // public
-time_t Day::get_date_time() const {
-    struct tm cp = date;
-    return std::mktime(&cp);
-}
+time_t Day::get_date_time() const { return Calendar::midnight(day); }
+
+// public
+int Day::get_day() const { return day; }
 
 // public
 struct tm Day::get_date() const { return date; }
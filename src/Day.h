@@ -2,15 +2,21 @@
 
 #include "Database.h"
 #include "Config.h"
+#include "Wrap.h"
+#include "LineMap.h"
+#include "BoxCache.h"
+#include "Calendar.h"
 
 // #include "include/curses.h"
 #include <ncursesw/ncurses.h>
 #include <cmath>
+#include <queue>
+#include <unordered_map>
 
 // represents one day, split up into time blocks (handles some ui)
 class Day {
 public:
-    Day(Database *db_ptr, Config *cfg_ptr, time_t date_);
+    Day(Database *db_ptr, Config *cfg_ptr, BoxCache *box_ptr, int day_);
 
     void set_focus_line(int line); // focus the block closest to this line number
     void set_focus_time(time_t absolute_time); // focus block closest to this time
@@ -18,8 +24,13 @@ public:
     void set_focus(int new_focus);
     bool set_focus_id(int id); // focus the block which has this id
                                // returns whether successful in finding the id or not
+    bool set_focus_start(time_t start, int track = 0); // the block starting then (same)
+
+    // highlight the blocks starting between these times, none if first is after last
+    void set_selection(time_t first, time_t last);
 
     int get_focus_line(); // get the currently focused line (approx)
+    int get_content_height() const; // lines the current layout takes up
     int get_focus();
 
     bool has_blocks();
@@ -27,7 +38,14 @@ public:
     Block get_focused_block();
     int get_focus_time_start(); // return id of focused black
 
-    void draw(int height, int width, int top_y, int left_x, bool focused); // draws the day in bounds
+    // lay out the blocks for a day of this size, time_per_line 0 fits the whole day in
+    // (layouts are kept per zoom level, so switching back is a lookup)
+    void layout(int height, int width, time_t time_per_line);
+    // draws the day into win, from line scroll of the layout down
+    void draw(WINDOW* win, int height, int width, time_t time_per_line, int scroll,
+              bool focused);
+    bool needs_redraw(time_t now) const; // whether the last draw is out of date
+    void mark_dirty(); // force a redraw next frame
     void set_highlighted(bool new_highlighted); // set whether or not day is highlighted
     
     void integrity_check() const;
@@ -39,25 +57,57 @@ public:
 
     struct tm get_date() const;
     time_t get_date_time() const;
+    int get_day() const; // civil day number (see Calendar)
     bool get_highlighted() const;
 
     void dump_info() const;
     
 private:
-    struct tm date; // the start of the day this object represents
+    int day; // the civil day this object represents
+    struct tm date; // the same day broken down, for formatting
     
     Database *database_ptr;
     Config *config_ptr;
+    BoxCache *box_cache_ptr; // shared box rows, owned by the week
 
     bool highlighted; // whether or not the day is highlighted
+    bool dirty; // whether something changed since the last draw
+    time_t cursor_minute; // the minute the today cursor was last drawn at
+    WINDOW* draw_win; // the window being drawn into (owned by the week)
     time_t day_start, day_end; // the hours the day begins and ends (preconfigured)
     std::string error_str;
 
     int last_height, last_width; // last height and width passed into resizing functions
     time_t last_time_per_line;
+    int content_height; // lines the blocks are laid out over (more than fit when zoomed)
+    int clip_top; // lines above this one are not drawn into (the top line or scrolled off)
+
+    struct layout_model { // where the blocks went at one zoom level
+        std::vector<std::pair<int, int>> rows; // top_y and height of each block
+        LineMap line_map;
+        int content_height;
+        time_t time_per_line;
+    };
+    // by time per line, or by negative height when the day is fit to the height
+    std::unordered_map<time_t, layout_model> layout_cache;
+    time_t layout_key; // the layout_cache entry the blocks are placed with (0 for none)
     
     std::string date_format;
     std::string day_format;
+
+    int background_color; // color pair of the rails around the day
+    int cursor_color; // color pair of the marker at the current time
+
+    struct top_line_model { // precomputed line above the day (date etc)
+        std::string rel_str, day_str, date_str;
+        bool today; // whether this day is today
+        int color; // color pair, -1 if the day isn't relative to today
+        time_t expiry; // the next midnight, when rel_str has to be recomputed
+        int width; // the width that text was composed for
+        int x; // column offset of text within the day
+        std::string text;
+    };
+    top_line_model top_line;
     
     int focused_block_idx; // the index of the focused uiblock
 
@@ -67,25 +117,58 @@ private:
         bool bottom_adjacent; // whether or not there is a block adjacent to it below
         int top_y; // the y position of the top of this block (relative to this day's pos)
         int height; // the height of this block
+        int column; // side by side with the blocks it overlaps, 0 is the leftmost
+        int stacked; // the blocks above it in its column of the cluster
+        int left_x, width; // the columns of the day it is drawn in, from its column
         std::vector<std::string> title_vec; // the title split up into lines (line wrap)
+
+        // render model, precomputed when the block is loaded
+        std::string start_str; // formatted start hour
+        std::string end_str; // formatted end hour
+        int color; // color pair the block is drawn in
+        BoxCache::en_box_type box_type;
+        bool collapsible;
     };
     std::vector<ui_block> ui_block_vec; // the list of blocks in this day
 
+    // a run of blocks that overlap each other (one block if it overlaps none)
+    // laid out as one block from the first start to the last end, the blocks in it
+    // split its width into columns and its lines by their times
+    struct cluster {
+        size_t first, last; // the indices of its blocks, both included
+        time_t start, end;
+        int column_count;
+        int depth; // the most blocks in one column, each needs lines for its borders
+        bool collapsible; // a lone collapsible block
+        int top_y, height;
+    };
+    std::vector<cluster> cluster_vec; // sorted by start, they don't overlap
+    LineMap line_map; // maps times to lines (and back) for the current layout
+
     bool is_today() const; // returns true if this day represents today
     std::string get_relative_day() const; // returns "Yesterday" "Today" "Tomorrow"
                        // "Next/Last Week" "Next/Last Month" "Next/Last Year" or ""
-    float get_line_at_time(time_t absolute_time); // returns the line number at unix tm
-    void resize_heights(int total_height); // sets line count, recalculates block height
+    // sets line count, recalculates block height (or takes them from layout_cache)
+    void resize_heights(int total_height, time_t time_per_line);
+    // the columns of the blocks and the clusters they form, a sweep in start order
+    // done when the blocks are loaded, so layouts and draws only look them up
+    void assign_columns();
+    void place_blocks(int total_height, time_t time_per_line); // top_y and height of each block
+    void place_in_clusters(); // the blocks' rows from the rows of their clusters
+    void build_line_map(); // rebuilds line_map from the current layout
     void resize_width(int total_width); // rearranges the title line wrapping of blocks
-    void draw_ui_block(struct ui_block uiblock, int height, // draw uiblock in given area
+    void draw_ui_block(const struct ui_block& uiblock, int height, // draw in given area
                        int width, int top_y, int left_x, bool focused);
     void draw_cursor(int top_y, int x_pos, bool focused); // draw marker at current time
-    void draw_top_line(int width, int top_y, int left_x, bool focused); // date etc
-    void draw_ui_block_title(struct ui_block uiblock, int height, int left_x, int top_y);
+    void update_top_line(int width); // recompute top_line if the width or date changed
+    void draw_top_line(int top_y, int left_x, bool focused); // date etc
+    void draw_ui_block_title(const struct ui_block& uiblock,
+                             int height, int left_x, int top_y);
     void populate_vector(); // using the database_ptr, load in today's tasks
 
     void set_focus_inbounds(); // move the focus back into bounds if it wasn't
     
-    enum en_box_type { BOX_NORMAL, BOX_IMPORTANT, BOX_BACKGROUND };
-    void custom_box(int height, int width, int top_y, int left_x, en_box_type type, bool filled);
+    void custom_box(int height, int width, int top_y, int left_x,
+                    BoxCache::en_box_type type, bool filled);
+    void put_str(int y, int x, const std::string& str); // skipped above clip_top
 };
@@ -0,0 +1,47 @@
+#include "EventLoop.h"
+
+EventLoop::EventLoop() {
+    pollfd_vec = {};
+    callback_vec = {};
+}
+
+// public
+void EventLoop::add_fd(int fd, std::function<void()> callback) {
+    if (fd < 0) throw std::runtime_error("event loop: can't watch invalid fd");
+
+    pollfd_vec.push_back({ fd, POLLIN, 0 });
+    callback_vec.push_back(callback);
+}
+
+// public
+void EventLoop::remove_fd(int fd) {
+    for (size_t i = 0; i < pollfd_vec.size(); i++) {
+        if (pollfd_vec[i].fd != fd) continue;
+
+        pollfd_vec.erase(pollfd_vec.begin() + i);
+        callback_vec.erase(callback_vec.begin() + i);
+        return;
+    }
+}
+
+// public
+bool EventLoop::wait(int timeout_ms) {
+    int ready = poll(pollfd_vec.data(), pollfd_vec.size(), timeout_ms);
+
+    if (ready < 0) {
+        if (errno == EINTR) return true; // a signal came in, let the caller look around
+        throw std::runtime_error("event loop: poll failed");
+    }
+
+    if (ready == 0) return false;
+
+    // callbacks may add or remove fds, so work from a copy
+    std::vector<struct pollfd> fired = pollfd_vec;
+    std::vector<std::function<void()>> callbacks = callback_vec;
+
+    for (size_t i = 0; i < fired.size(); i++) {
+        if (fired[i].revents & (POLLIN | POLLHUP | POLLERR)) callbacks[i]();
+    }
+
+    return true;
+}
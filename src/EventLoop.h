@@ -0,0 +1,24 @@
+#pragma once
+
+#include <poll.h>
+#include <functional>
+#include <vector>
+#include <stdexcept>
+#include <cerrno>
+
+// sleeps until one of its file descriptors becomes readable, then runs its callback
+class EventLoop {
+public:
+    EventLoop();
+
+    void add_fd(int fd, std::function<void()> callback); // run callback when fd is readable
+    void remove_fd(int fd);
+
+    // blocks for at most timeout_ms (forever if -1) and runs the callbacks of the ready
+    // fds, returns false if it timed out without anything happening
+    bool wait(int timeout_ms);
+
+private:
+    std::vector<struct pollfd> pollfd_vec;
+    std::vector<std::function<void()>> callback_vec; // same order as pollfd_vec
+};
@@ -0,0 +1,213 @@
+#include "Input.h"
+
+static const int ESCAPE_WAIT_MS = 25; // how long an escape waits for the rest of a sequence
+
+Input::Input(int in_fd_) {
+    in_fd = in_fd_;
+
+    notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (notify_fd < 0 || wake_fd < 0) throw std::runtime_error("input: unable to create eventfd");
+
+    stopping = false;
+    paused = parked = false;
+    pending = "";
+}
+
+Input::~Input() {
+    stop();
+    close(notify_fd);
+    close(wake_fd);
+}
+
+// public
+void Input::start() {
+    if (reader.joinable()) return;
+
+    stopping = false;
+    reader = std::thread([this]() { run(); });
+}
+
+// public
+void Input::stop() {
+    if (!reader.joinable()) return;
+
+    {
+        // under the lock, so a parked reader can't check it just before it waits
+        std::lock_guard<std::mutex> lock(pause_mutex);
+        stopping = true;
+    }
+    uint64_t one = 1;
+    write(wake_fd, &one, sizeof(one));
+    pause_cv.notify_all();
+
+    reader.join();
+}
+
+// public
+void Input::pause() {
+    if (!reader.joinable()) return;
+
+    std::unique_lock<std::mutex> lock(pause_mutex);
+    paused = true;
+
+    uint64_t one = 1;
+    write(wake_fd, &one, sizeof(one));
+
+    // the terminal only belongs to the other program once the reader stopped reading
+    pause_cv.wait(lock, [this]() { return parked; });
+}
+
+// public
+void Input::resume() {
+    std::lock_guard<std::mutex> lock(pause_mutex);
+    paused = false;
+    pause_cv.notify_all();
+}
+
+// public
+bool Input::pop(key_event& event) { return queue.pop(event); }
+
+// public
+void Input::clear_notification() {
+    uint64_t count;
+    read(notify_fd, &count, sizeof(count));
+}
+
+// private
+void Input::run() {
+    while (!stopping) {
+        struct pollfd fds[2] = { { in_fd, POLLIN, 0 }, { wake_fd, POLLIN, 0 } };
+
+        // a lone escape might still be the start of a sequence, so only wait a moment
+        bool waiting_escape = !pending.empty();
+        int ready = poll(fds, 2, waiting_escape ? ESCAPE_WAIT_MS : -1);
+
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            read(wake_fd, &count, sizeof(count));
+
+            if (stopping) return;
+            park();
+            continue;
+        }
+
+        if (ready == 0) { // nothing followed the escape
+            decode(true);
+            continue;
+        }
+
+        if (fds[0].revents & (POLLHUP | POLLERR)) return;
+
+        char buffer[256];
+        ssize_t count = read(in_fd, buffer, sizeof(buffer));
+        if (count <= 0) {
+            if (count < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+            return;
+        }
+
+        pending.append(buffer, count);
+        decode(false);
+    }
+}
+
+// private
+void Input::park() {
+    std::unique_lock<std::mutex> lock(pause_mutex);
+    if (!paused) return;
+
+    pending = ""; // a half read sequence belongs to nobody now
+
+    parked = true;
+    pause_cv.notify_all();
+    pause_cv.wait(lock, [this]() { return !paused || stopping; });
+    parked = false;
+
+    // whatever was typed into the other program is not for us
+    if (!stopping) tcflush(in_fd, TCIFLUSH);
+}
+
+// private
+void Input::decode(bool flush) {
+    size_t i = 0;
+
+    while (i < pending.size()) {
+        unsigned char byte = pending[i];
+
+        if (byte != 27) {
+            if (byte == 127 || byte == 8) emit(KEY_BACKSPACE);
+            else if (byte == '\r') emit('\n');
+            else emit(byte);
+
+            i++;
+            continue;
+        }
+
+        // escape sequences: ESC [ params final, or ESC O final
+        if (i + 1 >= pending.size()) {
+            if (!flush) break; // wait for the rest
+            emit(27);
+            i++;
+            continue;
+        }
+
+        char intro = pending[i + 1];
+        if (intro != '[' && intro != 'O') { // an escape followed by a normal key
+            emit(27);
+            i++;
+            continue;
+        }
+
+        size_t end = i + 2;
+        while (end < pending.size() && (pending[end] < 0x40 || pending[end] > 0x7e)) end++;
+
+        if (end >= pending.size()) {
+            if (!flush) break; // wait for the final byte
+            emit(27); // not a sequence after all
+            i++;
+            continue;
+        }
+
+        switch (pending[end]) {
+            case 'A': emit(KEY_UP);    break;
+            case 'B': emit(KEY_DOWN);  break;
+            case 'C': emit(KEY_RIGHT); break;
+            case 'D': emit(KEY_LEFT);  break;
+            default: break; // keys we have no use for
+        }
+
+        i = end + 1;
+    }
+
+    pending.erase(0, i);
+}
+
+// private
+void Input::emit(int key) {
+    // the ui is busy, wait for it instead of dropping the key
+    while (!queue.push({ key })) {
+        if (stopping) return;
+
+        // but it may be waiting for us to let go of the terminal, a key from this
+        // very burst can start an editor, so keep answering pauses meanwhile
+        struct pollfd wake = { wake_fd, POLLIN, 0 };
+        if (poll(&wake, 1, 1) <= 0) continue;
+
+        uint64_t count;
+        read(wake_fd, &count, sizeof(count));
+        if (stopping) return;
+
+        // parking empties pending, which also ends the decode this key came from,
+        // the rest of the burst went to the other program's side of the pause
+        park();
+        if (pending.empty()) return;
+    }
+
+    uint64_t one = 1;
+    write(notify_fd, &one, sizeof(one));
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "SpscQueue.h"
+
+// #include "include/curses.h"
+#include <ncursesw/ncurses.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string>
+#include <stdexcept>
+#include <cerrno>
+#include <chrono>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+// reads the terminal on its own thread and queues decoded keys for the ui thread,
+// so keys typed while the ui is busy are never lost or throttled to the frame rate
+class Input {
+public:
+    struct key_event {
+        int key; // a byte from the terminal, or one of the curses KEY_ codes for arrows etc
+    };
+
+    Input(int in_fd_);
+    ~Input();
+
+    void start(); // spawn the reader thread
+    void stop(); // join the reader thread
+
+    // stop reading the terminal while another program uses it, and take it back after
+    void pause();
+    void resume();
+
+    int get_notify_fd() const { return notify_fd; } // readable while keys are queued
+    bool pop(key_event& event); // ui thread only
+    void clear_notification(); // call before draining with pop
+
+private:
+    int in_fd; // the terminal
+    int notify_fd; // eventfd, bumped for every queued key
+    int wake_fd; // eventfd, wakes the reader thread for stop and pause
+
+    SpscQueue<key_event, 1024> queue;
+    std::thread reader;
+
+    std::atomic<bool> stopping;
+    std::mutex pause_mutex;
+    std::condition_variable pause_cv;
+    bool paused; // requested by the ui thread
+    bool parked; // reader thread acknowledged the pause
+
+    std::string pending; // bytes read but not yet decoded
+
+    void run(); // reader thread body
+    void park(); // block the reader thread while paused
+    void decode(bool flush); // turn pending bytes into keys, flush decides lone escapes
+    void emit(int key);
+};
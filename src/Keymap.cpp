@@ -0,0 +1,194 @@
+#include "Keymap.h"
+
+static const int MAX_COUNT = 9999;
+
+Keymap::Keymap(bool counts_, int timeout_ms_) {
+    node_vec = { { {}, -1 } };
+
+    counts = counts_;
+    timeout_ms = timeout_ms_;
+
+    current = 0;
+    count = 0;
+    keys = {};
+    held_key = -1;
+    last_key_time = std::chrono::steady_clock::now();
+
+    matched_command = -1;
+    matched_count = 1;
+    matched_counted = false;
+}
+
+Keymap::Keymap() : Keymap(false, -1) {}
+
+// public
+int Keymap::bind(const std::string& sequence, int command) {
+    std::vector<int> codes = parse_sequence(sequence);
+    if (codes.empty()) throw std::runtime_error("keymap: can't bind an empty sequence");
+
+    int idx = 0;
+    for (int key : codes) {
+        auto it = node_vec[idx].children.find(key);
+
+        if (it == node_vec[idx].children.end()) {
+            node_vec.push_back({ {}, -1 });
+            it = node_vec[idx].children.emplace(key, node_vec.size() - 1).first;
+        }
+
+        idx = it->second;
+    }
+
+    if (node_vec[idx].command != -1) return node_vec[idx].command;
+
+    node_vec[idx].command = command;
+    return -1;
+}
+
+// public
+Keymap::en_result Keymap::feed(int key) {
+    if (current == 0 && count == 0) keys.clear(); // the last match or rejection is done
+    last_key_time = std::chrono::steady_clock::now();
+
+    // digits before a binding are a count, unless a binding starts with that digit
+    bool is_digit = key < 128 && std::isdigit(key);
+    bool bound = node_vec[0].children.count(key) != 0;
+
+    if (counts && current == 0 && is_digit && !(count == 0 && (key == '0' || bound))) {
+        count = std::min(count * 10 + (key - '0'), MAX_COUNT);
+        return KM_PENDING;
+    }
+
+    keys.push_back(key);
+
+    auto it = node_vec[current].children.find(key);
+    if (it == node_vec[current].children.end()) {
+        if (node_vec[current].command != -1) { // the keys before it were a whole binding
+            keys.pop_back();
+            held_key = key;
+            return match();
+        }
+
+        current = count = 0; // can't match anything anymore
+        return KM_REJECT;
+    }
+
+    current = it->second;
+
+    // a binding that longer ones start with waits for the next key or the timeout
+    if (node_vec[current].command == -1 || !node_vec[current].children.empty())
+        return KM_PENDING;
+
+    return match();
+}
+
+// public
+bool Keymap::take_held_key(int& key) {
+    if (held_key == -1) return false;
+
+    key = held_key;
+    held_key = -1;
+    return true;
+}
+
+// public
+void Keymap::reset() {
+    current = count = 0;
+    keys.clear();
+    held_key = -1;
+}
+
+// public
+bool Keymap::is_pending() const { return current != 0 || count != 0; }
+
+// public
+std::string Keymap::get_pending_str() const {
+    if (!is_pending()) return "";
+
+    std::string str = (count == 0)? "" : std::to_string(count);
+    for (int key : keys) str += key_name(key);
+
+    return str;
+}
+
+// public
+int Keymap::get_ms_until_timeout() const {
+    if (!is_pending() || timeout_ms < 0) return -1;
+
+    int elapsed = std::chrono::duration_cast<std::chrono::milliseconds>
+                  (std::chrono::steady_clock::now() - last_key_time).count();
+
+    return std::max(timeout_ms - elapsed, 0);
+}
+
+// public
+Keymap::en_result Keymap::expire() {
+    if (!is_pending() || get_ms_until_timeout() > 0) return KM_PENDING;
+
+    if (node_vec[current].command != -1) return match();
+
+    current = count = 0; // keys stay readable for get_keys, like a rejection
+    return KM_REJECT;
+}
+
+// private
+Keymap::en_result Keymap::match() {
+    matched_command = node_vec[current].command;
+    matched_count = (count == 0)? 1 : count;
+    matched_counted = count != 0;
+    current = count = 0;
+
+    return KM_MATCH;
+}
+
+// public
+std::vector<int> Keymap::parse_sequence(const std::string& sequence) {
+    std::vector<int> codes;
+
+    for (size_t i = 0; i < sequence.size(); i++) {
+        size_t close = sequence.find('>', i);
+
+        if (sequence[i] == '<' && close != std::string::npos) {
+            std::string name = sequence.substr(i, close - i + 1);
+            int code = -1;
+
+            if      (name == "<left>")  code = KEY_LEFT;
+            else if (name == "<up>")    code = KEY_UP;
+            else if (name == "<down>")  code = KEY_DOWN;
+            else if (name == "<right>") code = KEY_RIGHT;
+            else if (name == "<bs>")    code = KEY_BACKSPACE;
+            else if (name == "<cr>")    code = 10;
+            else if (name == "<tab>")   code = 9;
+            else if (name == "<esc>")   code = 27;
+            else if (name.size() == 5 && name.compare(0, 3, "<c-") == 0
+                     && std::isalpha((unsigned char) name[3]))
+                code = std::tolower((unsigned char) name[3]) & 0x1f; // ctrl clears bits 5-7
+
+            if (code != -1) {
+                codes.push_back(code);
+                i = close;
+                continue;
+            }
+        }
+
+        codes.push_back((unsigned char) sequence[i]); // a plain char (or a byte of one)
+    }
+
+    return codes;
+}
+
+// public
+std::string Keymap::key_name(int key) {
+    switch (key) { // the appropriate escape, or just the char
+        case KEY_LEFT:      return "<left>";
+        case KEY_UP:        return "<up>";
+        case KEY_DOWN:      return "<down>";
+        case KEY_RIGHT:     return "<right>";
+        case KEY_BACKSPACE: return "<bs>";
+        case 10:            return "<cr>";
+        case 9:             return "<tab>";
+        case 27:            return "<esc>";
+        default:
+            if (key >= 1 && key <= 26) return std::string("<c-") + (char) ('a' + key - 1) + ">";
+            return std::string(1, (char) key);
+    }
+}
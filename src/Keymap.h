@@ -0,0 +1,70 @@
+#pragma once
+
+// #include "include/curses.h"
+#include <ncursesw/ncurses.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <stdexcept>
+#include <cctype>
+
+// the keybinds of one mode compiled into a trie, fed one key at a time
+// sequences are written like in the config: "gJ", "<c-r>", "g<down>"
+class Keymap {
+public:
+    enum en_result {
+        KM_PENDING, // the keys so far are the start of a binding (or a count)
+                    // or a whole one that longer ones start with, it waits for the timeout
+        KM_MATCH,   // a binding was completed, see get_command
+        KM_REJECT   // no binding starts like this, see get_keys for what was dropped
+    };
+
+    Keymap(bool counts_, int timeout_ms_); // timeout -1 waits forever
+    Keymap();
+
+    // the first bind of a sequence wins, returns the command that had it already, or -1
+    int bind(const std::string& sequence, int command);
+
+    // a key that can't continue a whole binding completes it, then is held for the next feed
+    en_result feed(int key);
+    bool take_held_key(int& key); // after KM_MATCH, whether a key was held back
+    void reset(); // drop whatever was typed so far
+
+    int get_command() const { return matched_command; } // after KM_MATCH
+    int get_count() const { return matched_count; } // after KM_MATCH, 1 if none was typed
+    bool get_counted() const { return matched_counted; } // after KM_MATCH, if one was typed
+    const std::vector<int>& get_keys() const { return keys; } // of the match or rejection
+
+    bool is_pending() const;
+    std::string get_pending_str() const; // the count and keys typed so far
+    int get_ms_until_timeout() const; // -1 if nothing is pending or there is no timeout
+    // once the pending keys timed out: KM_MATCH if they are a whole binding, else KM_REJECT
+    // (and they're dropped), KM_PENDING while they haven't
+    en_result expire();
+
+    static std::vector<int> parse_sequence(const std::string& sequence); // to key codes
+    static std::string key_name(int key); // how a key is written in the config
+
+private:
+    struct node {
+        std::unordered_map<int, int> children; // key code to node index
+        int command; // -1 if no binding ends here
+    };
+    std::vector<node> node_vec; // node 0 is the root
+
+    bool counts; // whether a number can be typed before a binding
+    int timeout_ms;
+
+    int current; // the node the keys so far lead to
+    int count; // 0 if no count was typed
+    std::vector<int> keys; // keys since the root (without the count)
+    int held_key; // -1 if none
+    std::chrono::steady_clock::time_point last_key_time;
+
+    int matched_command;
+    int matched_count;
+    bool matched_counted;
+
+    en_result match(); // the binding the keys so far lead to, back to the root
+};
@@ -0,0 +1,85 @@
+#include "LineMap.h"
+
+LineMap::LineMap() {
+    segment_vec = {};
+    focus_line_vec = {};
+}
+
+// public
+void LineMap::build(const std::vector<span>& spans, time_t day_start, time_t day_end,
+                    int total_height) {
+    segment_vec.clear();
+    focus_line_vec.clear();
+
+    if (spans.empty()) {
+        segment_vec.push_back({ day_start, day_end - day_start,
+                                0, (float) total_height - 0.33333f });
+        return;
+    }
+
+    int previous_end_line = 0;
+    time_t previous_end_time = day_start;
+
+    for (const span& sp : spans) {
+        // the gap between the last block and this one
+        // (the borders of the blocks around it are counted as a third of a line)
+        if (sp.start > previous_end_time) {
+            segment_vec.push_back({ previous_end_time, sp.start - previous_end_time,
+                                    previous_end_line - 0.33333f,
+                                    sp.top_y - previous_end_line + 0.66666f });
+        }
+
+        // the block itself, from the middle of the top border to the bottom border
+        segment_vec.push_back({ sp.start, sp.end - sp.start,
+                                sp.top_y + 0.5f, (float) sp.height - 1 });
+
+        // the line in the gap above where this block becomes the closer one
+        int gap_height = std::max(sp.top_y - previous_end_line, 0);
+        focus_line_vec.push_back(previous_end_line + gap_height / 2);
+
+        previous_end_line = sp.top_y + sp.height;
+        previous_end_time = sp.end;
+    }
+
+    // from the last block to the end of the day
+    if (day_end > previous_end_time) {
+        segment_vec.push_back({ previous_end_time, day_end - previous_end_time,
+                                previous_end_line - 0.33333f,
+                                total_height - previous_end_line + 0.33333f });
+    }
+}
+
+// public
+float LineMap::line_at_time(time_t absolute_time) const {
+    if (segment_vec.empty()) return 0;
+
+    absolute_time -= (absolute_time % 60); // remove seconds
+
+    // the last segment starting at or before the time
+    // (times outside of the day are extrapolated from the first or last one)
+    auto it = std::upper_bound(segment_vec.begin(), segment_vec.end(), absolute_time,
+        [](time_t t, const segment& seg) { return t < seg.start; });
+    if (it != segment_vec.begin()) it--;
+
+    if (it->duration == 0) return it->start_line;
+
+    // ret = start_line + height * (absolute_time - start) / duration
+    float ret = it->height;
+    ret /= it->duration;
+    ret *= absolute_time - it->start;
+    ret += it->start_line;
+
+    return ret;
+}
+
+// public
+int LineMap::index_at_line(int line) const {
+    if (focus_line_vec.empty()) return -1;
+
+    // the first block always wins above itself, so it is skipped in the search
+    auto it = std::upper_bound(focus_line_vec.begin() + 1, focus_line_vec.end(), line);
+    return it - focus_line_vec.begin() - 1;
+}
+
+// public
+bool LineMap::empty() const { return segment_vec.empty(); }
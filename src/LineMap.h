@@ -0,0 +1,38 @@
+#pragma once
+
+#include <ctime>
+#include <vector>
+#include <algorithm>
+
+// piecewise linear map between the times of a day and the lines of its layout
+// built once per layout, then answers lookups with a binary search
+class LineMap {
+public:
+    struct span { // where one block was laid out
+        time_t start, end; // absolute start and end times of the block
+        int top_y; // line of the top border of the block
+        int height; // including both borders
+    };
+
+    LineMap();
+
+    // spans must be sorted by start time, day_start and day_end are absolute times
+    void build(const std::vector<span>& spans, time_t day_start, time_t day_end,
+               int total_height);
+
+    float line_at_time(time_t absolute_time) const; // fractional line of the time
+    int index_at_line(int line) const; // index of the block closest to line (or -1)
+
+    bool empty() const;
+
+private:
+    struct segment { // one linear piece of the map
+        time_t start; // absolute time the piece starts at
+        time_t duration;
+        float start_line;
+        float height; // lines covered over the duration
+    };
+
+    std::vector<segment> segment_vec; // sorted by start
+    std::vector<int> focus_line_vec; // the first line at which each block is closest
+};
@@ -0,0 +1,210 @@
+#include "Occupancy.h"
+
+Occupancy::Occupancy() { bitmap_map = {}; }
+
+// public
+void Occupancy::add(time_t start, time_t end) { set_range(start, end, true); }
+
+// public
+void Occupancy::remove(time_t start, time_t end) { set_range(start, end, false); }
+
+// public
+void Occupancy::clear() { bitmap_map.clear(); }
+
+// public
+bool Occupancy::is_free(time_t start, time_t end) const {
+    return find_forward(start, end, true) >= end;
+}
+
+// public
+int Occupancy::busy_minutes(time_t start, time_t end) const {
+    int count = 0;
+
+    for (int day = Calendar::day_of(start); start < end; day++) {
+        time_t midnight = Calendar::midnight(day);
+        time_t segment_end = std::min(end, Calendar::midnight(day + 1));
+
+        auto it = bitmap_map.find(day);
+        if (it != bitmap_map.end()) {
+            count += count_bits(it->second, (start - midnight) / 60,
+                                (segment_end - midnight + 59) / 60);
+        }
+
+        start = segment_end;
+    }
+
+    return count;
+}
+
+// public
+time_t Occupancy::free_after(time_t start, time_t limit) const {
+    if (start >= limit) return 0;
+    return find_forward(start, limit, true) - start;
+}
+
+// public
+time_t Occupancy::free_before(time_t end, time_t limit) const {
+    if (end <= limit) return 0;
+    return end - find_backward(end, limit, true);
+}
+
+// public
+time_t Occupancy::first_free(time_t start, time_t duration, time_t limit) const {
+    // hop from free minute to busy minute, a word at a time, until a run is long enough
+    while (start + duration <= limit) {
+        start = find_forward(start, limit, false);
+        if (start + duration > limit) return -1;
+
+        time_t busy = find_forward(start, start + duration, true);
+        if (busy >= start + duration) return start;
+
+        start = busy;
+    }
+
+    return -1;
+}
+
+// public
+time_t Occupancy::last_free(time_t end, time_t duration, time_t limit) const {
+    // the same hops as first_free, back from end
+    while (end - duration >= limit) {
+        end = find_backward(end, limit, false);
+        if (end - duration < limit) return -1;
+
+        time_t busy = find_backward(end, end - duration, true);
+        if (busy <= end - duration) return end;
+
+        end = busy;
+    }
+
+    return -1;
+}
+
+// private
+void Occupancy::set_range(time_t start, time_t end, bool busy) {
+    for (int day = Calendar::day_of(start); start < end; day++) {
+        time_t midnight = Calendar::midnight(day);
+        time_t segment_end = std::min(end, Calendar::midnight(day + 1));
+
+        int first = (start - midnight) / 60;
+        int last = std::min((int) (segment_end - midnight + 59) / 60, DAY_MINUTES);
+
+        if (busy) {
+            bitmap& map = bitmap_map[day]; // zeroed when new
+
+            for (int minute = first; minute < last; minute++)
+                if (map.counts[minute]++ == 0) map.words[minute / 64] |= 1ULL << (minute % 64);
+        } else {
+            auto it = bitmap_map.find(day);
+
+            if (it != bitmap_map.end()) {
+                bitmap& map = it->second;
+                uint64_t any = 0;
+
+                // a minute only frees up once no block is left on it
+                for (int minute = first; minute < last; minute++) {
+                    if (map.counts[minute] > 0 && --map.counts[minute] == 0)
+                        map.words[minute / 64] &= ~(1ULL << (minute % 64));
+                }
+
+                for (int word = 0; word < WORDS; word++) any |= map.words[word];
+                if (any == 0) bitmap_map.erase(it); // nothing left on this day
+            }
+        }
+
+        start = segment_end;
+    }
+}
+
+// private
+time_t Occupancy::find_forward(time_t start, time_t limit, bool busy) const {
+    for (int day = Calendar::day_of(start); start < limit; day++) {
+        time_t midnight = Calendar::midnight(day);
+        time_t segment_end = std::min(limit, Calendar::midnight(day + 1));
+
+        int first = (start - midnight) / 60;
+        int last = (segment_end - midnight + 59) / 60;
+
+        auto it = bitmap_map.find(day);
+        int found;
+
+        if (it != bitmap_map.end()) found = find_bit(it->second, first, last, busy);
+        else found = busy? last : first; // a day without blocks is all free
+
+        if (found < last) return std::max(start, midnight + 60 * (time_t) found);
+
+        start = segment_end;
+    }
+
+    return limit;
+}
+
+// private
+time_t Occupancy::find_backward(time_t end, time_t limit, bool busy) const {
+    for (int day = Calendar::day_of(end - 1); end > limit; day--) {
+        time_t midnight = Calendar::midnight(day);
+        time_t segment_start = std::max(limit, midnight);
+
+        int first = (segment_start - midnight) / 60;
+        int last = (end - midnight + 59) / 60;
+
+        auto it = bitmap_map.find(day);
+        int found;
+
+        if (it != bitmap_map.end()) found = find_bit_reverse(it->second, first, last, busy);
+        else found = busy? -1 : last - 1;
+
+        if (found >= first) return std::min(end, midnight + 60 * (time_t) (found + 1));
+
+        end = segment_start;
+    }
+
+    return limit;
+}
+
+// private
+uint64_t Occupancy::range_mask(int word, int first, int last) {
+    int low = std::max(first - word * 64, 0);
+    int high = std::min(last - word * 64, 64);
+
+    uint64_t below_high = (high == 64)? ~0ULL : (1ULL << high) - 1;
+    uint64_t below_low = (1ULL << low) - 1;
+
+    return below_high & ~below_low;
+}
+
+// private
+int Occupancy::find_bit(const bitmap& map, int first, int last, bool value) {
+    for (int word = first / 64; word * 64 < last; word++) {
+        uint64_t bits = value? map.words[word] : ~map.words[word];
+        bits &= range_mask(word, first, last);
+
+        if (bits != 0) return word * 64 + __builtin_ctzll(bits); // lowest set bit
+    }
+
+    return last;
+}
+
+// private
+int Occupancy::find_bit_reverse(const bitmap& map, int first, int last, bool value) {
+    if (last <= first) return -1;
+
+    for (int word = (last - 1) / 64; word >= first / 64; word--) {
+        uint64_t bits = value? map.words[word] : ~map.words[word];
+        bits &= range_mask(word, first, last);
+
+        if (bits != 0) return word * 64 + 63 - __builtin_clzll(bits); // highest set bit
+    }
+
+    return -1;
+}
+
+// private
+int Occupancy::count_bits(const bitmap& map, int first, int last) {
+    int count = 0;
+
+    for (int word = first / 64; word * 64 < last; word++)
+        count += __builtin_popcountll(map.words[word] & range_mask(word, first, last));
+
+    return count;
+}
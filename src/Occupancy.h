@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Calendar.h"
+
+#include <cstdint>
+#include <ctime>
+#include <unordered_map>
+#include <algorithm>
+
+// which minutes of each day are taken by blocks, one bit per minute
+// placement checks look at a handful of 64 bit words instead of going thru the blocks
+// each minute also counts the blocks on it, so when blocks overlap (files edited by hand)
+// taking one out leaves the minutes the others still cover busy
+// times are expected on whole minutes (block times always are)
+class Occupancy {
+public:
+    Occupancy();
+
+    void add(time_t start, time_t end); // mark the minutes of this range as busy
+    void remove(time_t start, time_t end); // and as free again
+    void clear();
+
+    bool is_free(time_t start, time_t end) const;
+    int busy_minutes(time_t start, time_t end) const;
+
+    // seconds from start up to the first busy minute, or up to limit if there is none
+    time_t free_after(time_t start, time_t limit) const;
+    // seconds back from end to the last busy minute, or back to limit if there is none
+    time_t free_before(time_t end, time_t limit) const;
+    // start of the first free run this long at or after start, ending by limit (-1 if none)
+    time_t first_free(time_t start, time_t duration, time_t limit) const;
+    // end of the last free run this long at or before end, starting at limit or later
+    time_t last_free(time_t end, time_t duration, time_t limit) const;
+
+private:
+    static constexpr int DAY_MINUTES = 25 * 60; // the day dst ends is an hour longer
+    static constexpr int WORDS = (DAY_MINUTES + 63) / 64;
+
+    struct bitmap {
+        uint64_t words[WORDS]; // a bit per minute, set while its count isn't 0
+        uint16_t counts[DAY_MINUTES]; // blocks on each minute
+    };
+    std::unordered_map<int, bitmap> bitmap_map; // by civil day, only days with blocks
+
+    void set_range(time_t start, time_t end, bool busy);
+    // the first time at or after start that is in a minute with this state (or limit)
+    time_t find_forward(time_t start, time_t limit, bool busy) const;
+    // the end of the last minute before end that has this state (or limit)
+    time_t find_backward(time_t end, time_t limit, bool busy) const;
+
+    // word kernels over the minutes [first, last) of one day
+    static uint64_t range_mask(int word, int first, int last); // bits of the word in range
+    static int find_bit(const bitmap& map, int first, int last, bool value); // last if none
+    static int find_bit_reverse(const bitmap& map, int first, int last, bool value); // -1
+    static int count_bits(const bitmap& map, int first, int last);
+};
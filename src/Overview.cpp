@@ -0,0 +1,260 @@
+#include "Overview.h"
+
+const std::string Overview::shade_glyphs[5] = { " ", "░", "▒", "▓", "█" };
+
+Overview::Overview(Database* db_ptr, Config* cfg_ptr) {
+    database_ptr = db_ptr;
+    config_ptr = cfg_ptr;
+
+    scale = SCALE_MONTH;
+    focused_day = Calendar::today();
+
+    win = nullptr;
+    win_height = win_width = win_top_y = win_left_x = 0;
+    last_state = "";
+}
+
+Overview::Overview() {
+    database_ptr = nullptr;
+    config_ptr = nullptr;
+
+    scale = SCALE_MONTH;
+    focused_day = 0;
+
+    win = nullptr;
+    win_height = win_width = win_top_y = win_left_x = 0;
+    last_state = "";
+}
+
+// public
+void Overview::open(en_scale new_scale, int day) {
+    scale = new_scale;
+    focused_day = day;
+}
+
+// public
+void Overview::move_focus(int days) { focused_day += days; }
+
+// public
+void Overview::move_focus_rows(int rows) {
+    if (scale == SCALE_MONTH) focused_day += 7 * rows;
+    else focused_day = Calendar::add_months(focused_day, rows);
+}
+
+// public
+int Overview::get_focused_day() const { return focused_day; }
+
+// public
+Overview::en_scale Overview::get_scale() const { return scale; }
+
+// public
+std::string Overview::get_focus_summary() const {
+    const Database::day_summary& summary = database_ptr->get_day_summary(focused_day);
+
+    std::string str = format_day(focused_day, config_ptr->day_format) + " "
+                    + format_day(focused_day, config_ptr->date_format);
+
+    if (summary.block_count == 0) return str + "  free";
+
+    str += "  " + format_minutes(summary.busy_minutes) + " busy  "
+         + std::to_string(summary.block_count) + " blocks";
+    if (summary.important_count != 0)
+        str += "  " + std::to_string(summary.important_count) + " important";
+
+    return str;
+}
+
+// public
+void Overview::invalidate() { last_state = ""; }
+
+// public
+void Overview::draw(int height, int width, int top_y, int left_x) {
+    if (win == nullptr || win_height != height || win_width != width
+        || win_top_y != top_y || win_left_x != left_x) {
+        if (win != nullptr) delwin(win);
+
+        win = newwin(height, width, top_y, left_x);
+        win_height = height; win_width = width;
+        win_top_y = top_y; win_left_x = left_x;
+        last_state = "";
+    }
+
+    // the summaries can't change while the overview is up, only what is shown can
+    std::string state = std::to_string(scale) + "\n" + std::to_string(focused_day) + "\n"
+                      + std::to_string(Calendar::today());
+    if (state == last_state) return;
+    last_state = state;
+
+    werase(win);
+
+    if (scale == SCALE_MONTH) draw_month(height, width);
+    else draw_year(height, width);
+
+    wnoutrefresh(win); // pushed to the screen in doupdate
+}
+
+// private
+void Overview::draw_title(int width, const std::string& title) {
+    wattron(win, A_BOLD);
+    mvwaddstr(win, 0, std::max(0, (int) (width - title.size()) / 2), title.c_str());
+    wattroff(win, A_BOLD);
+}
+
+// private
+void Overview::draw_month(int height, int width) {
+    Calendar::civil focus = Calendar::civil_from_days(focused_day);
+    int first = Calendar::days_from_civil(focus.year, focus.month, 1);
+    int grid_start = first - (Calendar::weekday(first) + 6) % 7; // weeks start on monday
+
+    draw_title(width, format_day(first, "%B %Y"));
+
+    int cell_width = width / 7;
+    int cell_height = std::max(1, (height - 2) / 6);
+    int text_width = cell_width - 1; // one column between cells
+
+    if (text_width < 2) return;
+
+    for (int col = 0; col < 7; col++) {
+        std::string name = format_day(grid_start + col, "%a").substr(0, text_width);
+        mvwaddstr(win, 1, col * cell_width, name.c_str());
+    }
+
+    for (int row = 0; row < 6; row++) {
+        for (int col = 0; col < 7; col++) {
+            int day = grid_start + row * 7 + col;
+            const Database::day_summary& summary = database_ptr->get_day_summary(day);
+
+            int top_y = 2 + row * cell_height;
+            int left_x = col * cell_width;
+            bool in_month = Calendar::civil_from_days(day).month == focus.month;
+
+            // the day of the month, and the busy hours on the right
+            std::string number = std::to_string(Calendar::civil_from_days(day).day);
+            std::string busy = (summary.block_count == 0)? ""
+                             : format_minutes(summary.busy_minutes);
+
+            std::string line = number;
+            int spacer = text_width - (int) (number.size() + busy.size());
+            if (spacer > 0) line += std::string(spacer, ' ') + busy;
+            line = line.substr(0, text_width);
+
+            int attributes = attributes_of(day) | (in_month? 0 : A_DIM);
+            wattron(win, attributes);
+            mvwaddstr(win, top_y, left_x, line.c_str());
+            wattroff(win, attributes);
+
+            if (cell_height < 2 || summary.block_count == 0) continue;
+
+            // the counts, then the rest of the cell shaded by how busy the day was
+            std::string counts = std::to_string(summary.block_count) + " blocks";
+            if (summary.important_count != 0)
+                counts += " !" + std::to_string(summary.important_count);
+            counts = counts.substr(0, text_width);
+
+            if (!in_month) wattron(win, A_DIM);
+            mvwaddstr(win, top_y + 1, left_x, counts.c_str());
+
+            std::string shade_row;
+            for (int i = 0; i < text_width; i++) shade_row += shade_glyphs[shade_of(summary)];
+
+            // the last line of a cell is left empty as a gap, if there is room for one
+            int shade_end = (cell_height >= 4)? cell_height - 1 : cell_height;
+
+            wattron(win, COLOR_PAIR(color_of(summary)));
+            for (int y = 2; y < shade_end; y++)
+                mvwaddstr(win, top_y + y, left_x, shade_row.c_str());
+            wattroff(win, COLOR_PAIR(color_of(summary)));
+
+            if (!in_month) wattroff(win, A_DIM);
+        }
+    }
+}
+
+// private
+void Overview::draw_year(int height, int width) {
+    int year = Calendar::civil_from_days(focused_day).year;
+
+    draw_title(width, std::to_string(year));
+
+    const int label_width = 4; // "Jan "
+    int cell_width = std::min(3, std::max(1, (width - label_width) / 31));
+    int row_height = (height - 2 >= 24)? 2 : 1; // rows get a gap if there is room
+
+    // day of the month above every fifth column
+    for (int day = 1; day <= 31; day += (day == 1)? 4 : 5) {
+        mvwaddstr(win, 1, label_width + (day - 1) * cell_width, std::to_string(day).c_str());
+    }
+
+    for (int month = 1; month <= 12; month++) {
+        int top_y = 2 + (month - 1) * row_height;
+        int first = Calendar::days_from_civil(year, month, 1);
+
+        mvwaddstr(win, top_y, 0, format_day(first, "%b").substr(0, 3).c_str());
+
+        for (int i = 0; i < Calendar::days_in_month(year, month); i++) {
+            int day = first + i;
+            const Database::day_summary& summary = database_ptr->get_day_summary(day);
+
+            // the shade fills the cell but its last column, free days are just a dot
+            int shade = shade_of(summary);
+            std::string glyph = (summary.block_count == 0)? "·" : shade_glyphs[shade];
+            std::string cell;
+            for (int x = 0; x < std::max(1, cell_width - 1); x++) cell += glyph;
+
+            int attributes = attributes_of(day);
+            int color = color_of(summary);
+
+            wattron(win, attributes | COLOR_PAIR(color));
+            mvwaddstr(win, top_y, label_width + i * cell_width, cell.c_str());
+            wattroff(win, attributes | COLOR_PAIR(color));
+        }
+    }
+}
+
+// private
+int Overview::shade_of(const Database::day_summary& summary) const {
+    if (summary.busy_minutes <= 0) return 0;
+
+    // a quarter of the configured day per step
+    int day_minutes = std::max(1, (int) (config_ptr->day_end - config_ptr->day_start) / 60);
+    int shade = 1 + 4 * summary.busy_minutes / day_minutes;
+
+    return std::min(shade, 4);
+}
+
+// private
+int Overview::color_of(const Database::day_summary& summary) const {
+    int best = 0;
+
+    for (int color = 1; color < 8; color++)
+        if (summary.color_minutes[color] > summary.color_minutes[best]) best = color;
+
+    return best; // the same number as the color pair with that foreground
+}
+
+// private
+int Overview::attributes_of(int day) const {
+    int attributes = 0;
+
+    if (day == focused_day) attributes |= A_REVERSE;
+    if (day == Calendar::today()) attributes |= A_BOLD | A_UNDERLINE;
+
+    return attributes;
+}
+
+// private
+std::string Overview::format_day(int day, const std::string& format) const {
+    char buffer[40];
+    struct tm date = Calendar::to_tm(day);
+    std::strftime(buffer, sizeof(buffer), format.c_str(), &date);
+
+    return std::string(buffer);
+}
+
+// private
+std::string Overview::format_minutes(int minutes) const {
+    std::string str = std::to_string(minutes / 60) + "h";
+    if (minutes % 60 != 0) str += (minutes % 60 < 10? "0" : "") + std::to_string(minutes % 60);
+
+    return str;
+}
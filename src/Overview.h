@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Database.h"
+#include "Config.h"
+#include "Calendar.h"
+
+// #include "include/curses.h"
+#include <ncursesw/ncurses.h>
+#include <string>
+
+// month and year heatmaps of how busy days are
+// drawn only from the database's day summaries, so no blocks are looked at
+class Overview {
+public:
+    enum en_scale { SCALE_MONTH, SCALE_YEAR };
+
+    Overview(Database* db_ptr, Config* cfg_ptr);
+    Overview();
+
+    void open(en_scale new_scale, int day); // show the month or year around this day
+    void move_focus(int days);
+    void move_focus_rows(int rows); // a week per row in the month view, a month in the year
+
+    int get_focused_day() const;
+    en_scale get_scale() const;
+    std::string get_focus_summary() const; // one line about the focused day, for the bar
+
+    // draws into its own window (without doupdate), only if something changed
+    void draw(int height, int width, int top_y, int left_x);
+    void invalidate(); // redraw next frame
+
+private:
+    Database* database_ptr;
+    Config* config_ptr;
+
+    en_scale scale;
+    int focused_day;
+
+    static const std::string shade_glyphs[5]; // from free to busy all day
+
+    WINDOW* win;
+    int win_height, win_width, win_top_y, win_left_x;
+    std::string last_state; // everything the last draw depended on (empty forces a draw)
+
+    void draw_month(int height, int width);
+    void draw_year(int height, int width);
+    void draw_title(int width, const std::string& title);
+
+    int shade_of(const Database::day_summary& summary) const; // 0 (free) to 4 (all day)
+    int color_of(const Database::day_summary& summary) const; // the color with most minutes
+    int attributes_of(int day) const; // focus and today highlighting
+    std::string format_day(int day, const std::string& format) const; // strftime
+    std::string format_minutes(int minutes) const; // like 5h30
+};
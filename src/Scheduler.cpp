@@ -0,0 +1,156 @@
+#include "Scheduler.h"
+
+Scheduler::Scheduler(Database* db_ptr, Config* cfg_ptr) {
+    database_ptr = db_ptr;
+    config_ptr = cfg_ptr;
+}
+
+// public
+std::vector<Scheduler::task> Scheduler::read_tasks(const std::filesystem::path& path,
+                                                    int first_day) const {
+    std::ifstream file(path);
+    if (!file.is_open()) throw std::runtime_error("unable to open " + path.string());
+
+    std::vector<task> tasks;
+    std::string line;
+    int linenum = 0;
+
+    while (std::getline(file, line)) {
+        linenum++;
+
+        line = line.substr(0, line.find('#'));
+        boost::algorithm::trim(line);
+        if (line.empty()) continue;
+
+        try {
+            tasks.push_back(parse_task(line, first_day));
+        } catch (const std::runtime_error& err) {
+            throw std::runtime_error(path.filename().string() + " line "
+                                     + std::to_string(linenum) + ", " + err.what());
+        }
+    }
+
+    return tasks;
+}
+
+// public
+std::vector<Scheduler::task> Scheduler::schedule(std::vector<task> tasks,
+                                                 int first_day, int day_count) {
+    std::stable_sort(tasks.begin(), tasks.end(), [](const task& a, const task& b) {
+        if (a.important != b.important) return a.important;
+        if (a.last_day != b.last_day) return a.last_day < b.last_day;
+        return a.duration > b.duration;
+    });
+
+    int last_day = first_day + day_count - 1;
+    std::vector<task> unplaced;
+
+    database_ptr->begin_transaction(); // one undo takes the whole schedule back
+
+    for (const task& t : tasks) {
+        time_t start = place(t, std::max(first_day, t.first_day), std::min(last_day, t.last_day));
+        if (start < 0) { unplaced.push_back(t); continue; }
+
+        Block block(config_ptr, 0); // the id is handed out when it is added
+        block.set_title(t.title);
+        block.set_time_t_start(start);
+        block.set_duration(t.duration);
+        block.set_color_str(t.color);
+        block.set_important(t.important);
+
+        if (!database_ptr->add_block(block)) unplaced.push_back(t);
+    }
+
+    database_ptr->end_transaction();
+
+    return unplaced;
+}
+
+// private
+time_t Scheduler::place(const task& t, int first_day, int last_day) const {
+    time_t now = time(0);
+    time_t next_minute = now - now % 60 + 60; // nothing goes in the past
+
+    for (int day = first_day; day <= last_day; day++) {
+        time_t midnight = Calendar::midnight(day);
+        time_t day_end = midnight + config_ptr->day_end;
+        time_t start = std::max(midnight + config_ptr->day_start, next_minute);
+
+        if (start + t.duration > day_end) continue;
+
+        time_t slot = database_ptr->find_free_slot(start, t.duration, day_end);
+        if (slot >= 0) return slot;
+    }
+
+    return -1;
+}
+
+// private
+Scheduler::task Scheduler::parse_task(const std::string& line, int first_day) const {
+    std::vector<std::string> words;
+    boost::algorithm::split(words, line, boost::algorithm::is_space(),
+                            boost::algorithm::token_compress_on);
+
+    task t = { "", parse_duration(words[0]), "white", false,
+               std::numeric_limits<int>::min(), std::numeric_limits<int>::max() };
+    if (t.duration <= 0) throw std::runtime_error("invalid duration: " + words[0]);
+
+    for (size_t i = 1; i < words.size(); i++) {
+        const std::string& word = words[i];
+
+        if (word == "!") t.important = true;
+        else if (word.size() > 1 && word[0] == '@') {
+            Block probe(config_ptr, 0);
+            probe.set_color_str(word.substr(1)); // ignores names it doesn't know
+            if (probe.get_color_str() != word.substr(1))
+                throw std::runtime_error("invalid color: " + word.substr(1));
+
+            t.color = word.substr(1);
+        }
+        else if (word.rfind("from:", 0) == 0) t.first_day = parse_date(word.substr(5), first_day);
+        else if (word.rfind("by:", 0) == 0) t.last_day = parse_date(word.substr(3), first_day);
+        else t.title += (t.title.empty()? "" : " ") + word;
+    }
+
+    if (t.title.empty()) throw std::runtime_error("task has no title");
+    if (t.first_day > t.last_day) throw std::runtime_error("task is due before it starts");
+
+    return t;
+}
+
+// private
+time_t Scheduler::parse_duration(const std::string& word) const {
+    time_t duration = 0;
+    size_t pos = 0;
+
+    // a number followed by h, then optionally minutes (with or without the m)
+    // or just a number of minutes followed by m
+    while (pos < word.size()) {
+        size_t digits = std::min(word.find_first_not_of("0123456789", pos), word.size());
+        if (digits == pos || digits - pos > 5) return 0; // also keeps stol in range
+
+        time_t value = std::stol(word.substr(pos, digits - pos));
+
+        if (digits == word.size()) { // trailing minutes of 1h30
+            if (duration == 0) return 0;
+            return duration + 60 * value;
+        }
+
+        if (word[digits] == 'h' && duration == 0) duration += 60 * 60 * value;
+        else if (word[digits] == 'm' && digits + 1 == word.size()) duration += 60 * value;
+        else return 0;
+
+        pos = digits + 1;
+    }
+
+    return duration;
+}
+
+// private
+int Scheduler::parse_date(const std::string& word, int first_day) const {
+    int day;
+    if (!Calendar::parse_date(word, config_ptr->date_format, first_day, day))
+        throw std::runtime_error("invalid date: " + word);
+
+    return day;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Database.h"
+#include "Config.h"
+#include "Calendar.h"
+
+#include <boost/algorithm/string.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// packs a list of unscheduled tasks into the free time of a range of days
+// the gaps come from the database's occupancy bitmaps, so no blocks are looked at
+class Scheduler {
+public:
+    struct task {
+        std::string title;
+        time_t duration; // seconds
+        std::string color; // one of the block color names
+        bool important;
+        int first_day, last_day; // civil days it may go on (from: and by:)
+    };
+
+    Scheduler(Database* db_ptr, Config* cfg_ptr);
+
+    // one task per line, like: 1h30 write report ! @red from:21.10 by:25.10
+    // (the duration first, dates in the date format, # starts a comment)
+    // dates without a year are the next time that date comes from first_day
+    // throws with the line number on anything it can't read
+    std::vector<task> read_tasks(const std::filesystem::path& path, int first_day) const;
+
+    // places each task in the first free gap between day start and day end that fits it,
+    // important tasks first, then by deadline, then the longest (first fit decreasing)
+    // all blocks are created in one transaction, returns the tasks that didn't fit
+    std::vector<task> schedule(std::vector<task> tasks, int first_day, int day_count);
+
+private:
+    Database* database_ptr;
+    Config* config_ptr;
+
+    task parse_task(const std::string& line, int first_day) const; // throws without context
+    time_t parse_duration(const std::string& word) const; // 90m, 1h or 1h30, 0 if invalid
+    int parse_date(const std::string& word, int first_day) const;
+    time_t place(const task& t, int first_day, int last_day) const; // start, -1 if no room
+};
@@ -0,0 +1,228 @@
+#include "SearchIndex.h"
+
+SearchIndex::SearchIndex(std::filesystem::path save_folder_) {
+    save_folder = save_folder_;
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0)
+        throw std::runtime_error("unable to watch save folder: " + save_folder.string());
+
+    // watched before the first scan, so nothing written in between is missed
+    if (inotify_add_watch(inotify_fd, save_folder.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0)
+        throw std::runtime_error("unable to watch save folder: " + save_folder.string());
+
+    for (const std::filesystem::path& file : std::filesystem::directory_iterator(save_folder))
+        index_file(file.filename().string());
+}
+
+SearchIndex::~SearchIndex() { close(inotify_fd); }
+
+// public
+bool SearchIndex::handle_changes() {
+    alignas(struct inotify_event) char buffer[4096];
+    bool changed = false;
+    ssize_t length;
+
+    while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + length; ) {
+            const struct inotify_event* event = (const struct inotify_event*) ptr;
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0) continue;
+            changed = true;
+
+            // renames come as the old name leaving and the new one arriving
+            if (event->mask & (IN_MOVED_FROM | IN_DELETE)) remove_file(event->name);
+            else index_file(event->name);
+        }
+    }
+
+    return changed;
+}
+
+// public
+std::vector<SearchIndex::hit> SearchIndex::query(const std::string& text, size_t limit) const {
+    std::string needle = lowercase(text);
+    std::vector<hit> hits;
+    if (needle.empty()) return hits;
+
+    std::vector<uint32_t> needle_trigrams = trigrams_of(needle);
+    std::vector<int> candidates;
+
+    if (needle_trigrams.empty()) { // too short to have any, look at everything
+        for (const auto& [id, doc] : doc_map) candidates.push_back(id);
+    } else {
+        // intersect the postings, shortest first so the candidates shrink fast
+        std::vector<const std::vector<int>*> lists;
+        for (uint32_t trigram : needle_trigrams) {
+            auto it = postings.find(trigram);
+            if (it != postings.end()) lists.push_back(&it->second);
+        }
+
+        std::sort(lists.begin(), lists.end(),
+            [](const std::vector<int>* a, const std::vector<int>* b) { return a->size() < b->size(); });
+
+        if (lists.size() == needle_trigrams.size()) {
+            candidates = *lists[0];
+
+            for (size_t i = 1; i < lists.size() && !candidates.empty(); i++) {
+                std::vector<int> narrowed;
+                std::set_intersection(candidates.begin(), candidates.end(),
+                                      lists[i]->begin(), lists[i]->end(),
+                                      std::back_inserter(narrowed));
+                candidates.swap(narrowed);
+            }
+        }
+    }
+
+    // the trigrams only say it might be there, the text says whether it is
+    for (int id : candidates) {
+        const document& doc = doc_map.at(id);
+
+        if (doc.title.find(needle) != std::string::npos) hits.push_back({ id, 2 });
+        else if (doc.notes.find(needle) != std::string::npos) hits.push_back({ id, 1 });
+    }
+
+    // typos and other orders: count the query trigrams each block has
+    if (needle_trigrams.size() >= 2) {
+        std::unordered_map<int, int> shared;
+
+        for (uint32_t trigram : needle_trigrams) {
+            auto it = postings.find(trigram);
+            if (it == postings.end()) continue;
+
+            for (int id : it->second) shared[id]++;
+        }
+
+        std::vector<int> found;
+        for (const hit& h : hits) found.push_back(h.id);
+        std::sort(found.begin(), found.end());
+
+        for (const auto& [id, count] : shared) {
+            if (2 * count < (int) needle_trigrams.size()) continue;
+            if (std::binary_search(found.begin(), found.end(), id)) continue;
+
+            hits.push_back({ id, 0.99 * count / needle_trigrams.size() });
+        }
+    }
+
+    std::sort(hits.begin(), hits.end(), [](const hit& a, const hit& b) {
+        return (a.score != b.score)? a.score > b.score : a.id < b.id;
+    });
+
+    if (hits.size() > limit) hits.resize(limit);
+    return hits;
+}
+
+// private
+void SearchIndex::index_file(const std::string& filename) {
+    std::string title;
+    int id;
+    if (!parse_filename(filename, title, id)) return;
+
+    std::filesystem::path file = save_folder / filename;
+    if (!std::filesystem::is_regular_file(file)) return;
+
+    remove(id);
+
+    document doc = { filename, lowercase(title), lowercase(read_notes(file)), {} };
+    doc.trigrams = trigrams_of(doc.title + "\n" + doc.notes);
+
+    for (uint32_t trigram : doc.trigrams) {
+        std::vector<int>& ids = postings[trigram];
+        ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+    }
+
+    doc_map[id] = std::move(doc);
+}
+
+// private
+void SearchIndex::remove(int id) {
+    auto it = doc_map.find(id);
+    if (it == doc_map.end()) return;
+
+    for (uint32_t trigram : it->second.trigrams) {
+        std::vector<int>& ids = postings[trigram];
+        ids.erase(std::lower_bound(ids.begin(), ids.end(), id));
+
+        if (ids.empty()) postings.erase(trigram);
+    }
+
+    doc_map.erase(it);
+}
+
+// private
+void SearchIndex::remove_file(const std::string& filename) {
+    std::string title;
+    int id;
+    if (!parse_filename(filename, title, id)) return;
+
+    auto it = doc_map.find(id);
+    if (it != doc_map.end() && it->second.filename == filename) remove(id);
+}
+
+// private
+bool SearchIndex::parse_filename(const std::string& filename, std::string& title, int& id) {
+    // <title>.<id>.norg, the same as Block reads them
+    const std::string extension = ".norg";
+    if (filename.size() <= extension.size()
+        || filename.compare(filename.size() - extension.size(), extension.size(), extension) != 0)
+        return false;
+
+    std::string stem = filename.substr(0, filename.size() - extension.size());
+    size_t period_pos = stem.find('.');
+    if (period_pos == std::string::npos || period_pos == 0) return false;
+
+    std::string id_str = stem.substr(period_pos + 1);
+    if (id_str.empty() || id_str.size() > 5
+        || id_str.find_first_not_of("0123456789") != std::string::npos) return false;
+
+    title = stem.substr(0, period_pos);
+    id = std::stoi(id_str);
+
+    return true;
+}
+
+// private
+std::string SearchIndex::read_notes(const std::filesystem::path& file) {
+    std::ifstream stream(file);
+    std::string notes, line;
+    bool in_section = false;
+
+    while (std::getline(stream, line)) {
+        std::string trimmed = boost::algorithm::trim_copy(line);
+
+        if (!in_section && (trimmed == "@document.meta" || trimmed == "@code lua time"))
+            in_section = true;
+        else if (in_section && trimmed == "@end")
+            in_section = false;
+        else if (!in_section && !trimmed.empty())
+            notes += trimmed + "\n";
+    }
+
+    return notes;
+}
+
+// private
+std::string SearchIndex::lowercase(std::string str) {
+    // bytes of multibyte characters are left alone
+    for (char& c : str) if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+    return str;
+}
+
+// private
+std::vector<uint32_t> SearchIndex::trigrams_of(const std::string& str) {
+    std::vector<uint32_t> trigrams;
+
+    for (size_t i = 0; i + 3 <= str.size(); i++) {
+        trigrams.push_back((uint32_t) (unsigned char) str[i] << 16
+                         | (uint32_t) (unsigned char) str[i + 1] << 8
+                         | (uint32_t) (unsigned char) str[i + 2]);
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    return trigrams;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <boost/algorithm/string.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+// trigram index over the titles and notes of every block file in the save folder
+// kept up to date by watching the folder, so edits made here and in other programs
+// (the editor, sync tools) go thru the same path
+class SearchIndex {
+public:
+    struct hit {
+        int id; // of the block or series
+        double score; // 2 title contains the query, 1 notes do, below 1 the trigrams shared
+    };
+
+    SearchIndex(std::filesystem::path save_folder_);
+    ~SearchIndex();
+
+    int get_change_fd() const { return inotify_fd; } // readable when a file changed
+    bool handle_changes(); // reindex the files that changed, returns whether any did
+
+    // case insensitive, substring matches first, then fuzzy ones that share
+    // at least half of the query's trigrams (best first, at most limit)
+    std::vector<hit> query(const std::string& text, size_t limit) const;
+
+    size_t size() const { return doc_map.size(); }
+
+private:
+    struct document {
+        std::string filename;
+        std::string title; // lowercased, like everything that is searched
+        std::string notes; // the lines outside the meta and time sections
+        std::vector<uint32_t> trigrams; // unique, to take it back out of the postings
+    };
+
+    std::filesystem::path save_folder;
+    int inotify_fd;
+
+    std::unordered_map<int, document> doc_map; // by block id
+    std::unordered_map<uint32_t, std::vector<int>> postings; // trigram to sorted ids
+
+    void index_file(const std::string& filename); // (re)reads it, ignores other files
+    void remove(int id);
+    void remove_file(const std::string& filename); // only if it is still that id's file
+
+    static bool parse_filename(const std::string& filename, std::string& title, int& id);
+    static std::string read_notes(const std::filesystem::path& file);
+    static std::string lowercase(std::string str);
+    static std::vector<uint32_t> trigrams_of(const std::string& str); // unique, sorted
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// lock free ring buffer for exactly one producer thread and one consumer thread
+template <typename T, size_t capacity>
+class SpscQueue {
+    static_assert(capacity != 0 && (capacity & (capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // producer only, returns false if the queue is full
+    bool push(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == capacity) return false;
+
+        slots[t & (capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release); // publish the slot
+
+        return true;
+    }
+
+    // consumer only, returns false if the queue is empty
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+
+        item = slots[h & (capacity - 1)];
+        head.store(h + 1, std::memory_order_release); // hand the slot back
+
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    T slots[capacity];
+
+    // on separate cache lines so the two threads don't fight over them
+    alignas(64) std::atomic<size_t> head; // next slot to pop (written by consumer)
+    alignas(64) std::atomic<size_t> tail; // next slot to push (written by producer)
+};
@@ -0,0 +1,210 @@
+#include "Templates.h"
+
+Templates::Templates(Database* db_ptr, Config* cfg_ptr) {
+    database_ptr = db_ptr;
+    config_ptr = cfg_ptr;
+}
+
+// public
+std::vector<std::string> Templates::list() const {
+    std::vector<std::string> names;
+    if (!std::filesystem::is_directory(config_ptr->templates_path)) return names;
+
+    for (const std::filesystem::path& file
+        : std::filesystem::directory_iterator(config_ptr->templates_path)) {
+        if (file.extension() == ".txt") names.push_back(file.stem().string());
+    }
+
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// public
+int Templates::capture(const std::string& name, int first_day, int day_count) {
+    std::filesystem::path path = path_of(name);
+    std::filesystem::create_directories(path.parent_path());
+
+    std::ofstream file(path);
+    if (!file.is_open()) throw std::runtime_error("unable to write " + path.string());
+
+    file << day_count << std::endl;
+    int count = 0;
+
+    for (int day = first_day; day < first_day + day_count; day++) {
+        for (const Block& block : database_ptr->get_blocks_on_day(day)) {
+            file << day - first_day << " " << clock_str(clock_of(block.get_time_t_start()))
+                 << " " << clock_str(block.get_duration()) << " @" << block.get_color_str()
+                 << (block.get_important()? " !" : "") << (block.get_collapsible()? " ~" : "")
+                 << (block.get_track() != 0? " +" + std::to_string(block.get_track()) : "")
+                 << " -- " << block.get_title() << std::endl;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// public
+int Templates::apply(const std::string& name, int first_day, int repeats, int& total) {
+    int day_count;
+    std::vector<entry> entries = read(name, day_count);
+
+    if (day_count % 7 == 0) first_day -= (Calendar::weekday(first_day) + 6) % 7; // monday
+
+    std::vector<Block> blocks;
+
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (const entry& e : entries) {
+            int day = first_day + repeat * day_count + e.day;
+
+            Block block(config_ptr, 0); // the id is handed out when it is added
+            block.set_title(e.title);
+            block.set_time_t_start(time_at(day, e.start));
+            block.set_duration(e.duration);
+            block.set_color_str(e.color);
+            block.set_important(e.important);
+            block.set_collapsible(e.collapsible);
+            block.set_track(e.track);
+
+            blocks.push_back(block);
+        }
+    }
+
+    total = blocks.size();
+    return database_ptr->add_blocks(blocks);
+}
+
+// private
+std::filesystem::path Templates::path_of(const std::string& name) const {
+    if (name.empty() || name.find('/') != std::string::npos || name[0] == '.')
+        throw std::runtime_error("invalid template name: " + name);
+
+    return config_ptr->templates_path / (name + ".txt");
+}
+
+// private
+std::vector<Templates::entry> Templates::read(const std::string& name, int& day_count) const {
+    std::filesystem::path path = path_of(name);
+
+    std::ifstream file(path);
+    if (!file.is_open()) throw std::runtime_error("no template named " + name);
+
+    std::vector<entry> entries;
+    std::string line;
+    int linenum = 0;
+    day_count = 0;
+
+    while (std::getline(file, line)) {
+        linenum++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        // only whole lines are comments, titles can have a # in them
+        std::string trimmed = boost::algorithm::trim_copy(line);
+        if (trimmed.empty() || trimmed[0] == '#') continue;
+
+        try {
+            if (day_count == 0) { // the first line says how many days it covers
+                size_t end;
+                day_count = std::stoi(trimmed, &end);
+                if (end != trimmed.size() || day_count < 1 || day_count > 366)
+                    throw std::runtime_error("invalid day count: " + trimmed);
+            }
+            else entries.push_back(parse_entry(line, day_count));
+        } catch (const std::logic_error&) { // from stoi
+            throw std::runtime_error(path.filename().string() + " line "
+                                     + std::to_string(linenum) + ", invalid number");
+        } catch (const std::runtime_error& err) {
+            throw std::runtime_error(path.filename().string() + " line "
+                                     + std::to_string(linenum) + ", " + err.what());
+        }
+    }
+
+    if (day_count == 0) throw std::runtime_error(path.filename().string() + " is empty");
+
+    return entries;
+}
+
+// private
+Templates::entry Templates::parse_entry(const std::string& line, int day_count) const {
+    std::istringstream stream(line);
+    std::string day_word, start_word, duration_word, word;
+    stream >> day_word >> start_word >> duration_word;
+
+    entry e = { 0, parse_clock(start_word), parse_clock(duration_word), "", "white",
+                false, false, 0 };
+
+    size_t end;
+    e.day = std::stoi(day_word, &end);
+    if (end != day_word.size() || e.day < 0 || e.day >= day_count)
+        throw std::runtime_error("invalid day: " + day_word);
+
+    if (e.start < 0 || e.start >= 24*60*60)
+        throw std::runtime_error("invalid start: " + start_word);
+    if (e.duration <= 0) throw std::runtime_error("invalid duration: " + duration_word);
+
+    bool titled = false;
+    while (stream >> word) {
+        if (word == "!") e.important = true;
+        else if (word == "~") e.collapsible = true;
+        else if (word.size() > 1 && word[0] == '@') e.color = word.substr(1);
+        else if (word.size() == 2 && word[0] == '+' && std::isdigit((unsigned char) word[1])) {
+            e.track = word[1] - '0';
+            if (e.track >= Block::TRACK_COUNT) throw std::runtime_error("invalid track: " + word);
+        }
+        else if (word == "--") { // the title is the rest of the line as is, never flags
+            std::getline(stream, e.title);
+            if (!e.title.empty() && e.title[0] == ' ') e.title.erase(0, 1);
+            titled = true;
+            break;
+        }
+        else throw std::runtime_error("invalid flag: " + word);
+    }
+
+    if (!titled) throw std::runtime_error("missing -- before the title");
+
+    Block probe(config_ptr, 0);
+    probe.set_color_str(e.color); // ignores names it doesn't know
+    if (probe.get_color_str() != e.color) throw std::runtime_error("invalid color: " + e.color);
+
+    return e;
+}
+
+// private
+time_t Templates::parse_clock(const std::string& word) {
+    size_t colon = word.find(':');
+    if (colon == std::string::npos || colon == 0 || colon > 2 || word.size() != colon + 3)
+        return -1;
+    if (word.find_first_not_of("0123456789:") != std::string::npos) return -1;
+    if (word.find(':', colon + 1) != std::string::npos) return -1;
+
+    int hours = std::stoi(word.substr(0, colon));
+    int minutes = std::stoi(word.substr(colon + 1));
+    if (minutes >= 60) return -1;
+
+    return 60*60*hours + 60*minutes;
+}
+
+// private
+std::string Templates::clock_str(time_t seconds) {
+    int minutes = seconds / 60 % 60;
+    return std::to_string(seconds / 60 / 60) + ":" + (minutes < 10? "0" : "")
+         + std::to_string(minutes);
+}
+
+// private
+time_t Templates::clock_of(time_t time) {
+    struct tm local;
+    localtime_r(&time, &local);
+
+    return 60*60*local.tm_hour + 60*local.tm_min;
+}
+
+// private
+time_t Templates::time_at(int day, time_t clock) {
+    struct tm local = Calendar::to_tm(day);
+    local.tm_hour = clock / (60*60);
+    local.tm_min = clock / 60 % 60;
+    local.tm_isdst = -1; // to_tm leaves it to mktime too
+
+    return std::mktime(&local);
+}
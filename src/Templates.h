@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Database.h"
+#include "Config.h"
+#include "Calendar.h"
+
+#include <boost/algorithm/string.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// named layouts of a day or a week, saved from the week and put back on other days
+// kept as text files in the templates folder: the number of days on the first line,
+// then one block per line, its day, start, length, @color ! (important) ~ (collapsible)
+// +track (when not the first), then -- and the title as is, like:
+// 0 7:00 0:45 @white ! -- shower brekky dress
+// lines starting with # are comments
+class Templates {
+public:
+    Templates(Database* db_ptr, Config* cfg_ptr);
+
+    std::vector<std::string> list() const; // names of the saved templates, sorted
+
+    // saves the blocks of day_count days from first_day under this name (replacing it)
+    // returns how many blocks went in
+    int capture(const std::string& name, int first_day, int day_count);
+
+    // puts the template on its days from first_day on, repeats times in a row, as one undo
+    // (templates of whole weeks start on the monday of the week first_day is in)
+    // blocks that would land on others are left out, returns how many were added of total
+    int apply(const std::string& name, int first_day, int repeats, int& total);
+
+private:
+    struct entry {
+        int day; // counted from the first day of the template
+        time_t start; // the wall clock time of day, in seconds
+        time_t duration;
+        std::string title, color;
+        bool important, collapsible;
+        int track;
+    };
+
+    Database* database_ptr;
+    Config* config_ptr;
+
+    std::filesystem::path path_of(const std::string& name) const; // throws on bad names
+    std::vector<entry> read(const std::string& name, int& day_count) const;
+    entry parse_entry(const std::string& line, int day_count) const; // throws without context
+    static time_t parse_clock(const std::string& word); // h:mm in seconds, -1 if invalid
+    static std::string clock_str(time_t seconds);
+    // by the wall clock, seconds after midnight are off by an hour on days the clocks change
+    static time_t clock_of(time_t time);
+    static time_t time_at(int day, time_t clock);
+};
@@ -0,0 +1,16 @@
+#include "TermOutput.h"
+
+static std::atomic<size_t> bytes_written(0);
+
+// public
+size_t TermOutput::get_bytes_written() { return bytes_written.load(std::memory_order_relaxed); }
+
+// every write from outside libc comes thru here, the ones curses sends the terminal too
+// (libc's own, like those flushing std::cout, go to the syscall directly and aren't counted)
+extern "C" ssize_t write(int fd, const void* buffer, size_t count) {
+    ssize_t written = syscall(SYS_write, fd, buffer, count);
+    if (fd == STDOUT_FILENO && written > 0)
+        bytes_written.fetch_add(written, std::memory_order_relaxed);
+
+    return written;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// counts the bytes sent to the terminal, for the frame size stats
+// curses writes its output buffer straight to the terminal's file descriptor with
+// write(2), past stdio, so the count is taken by a write standing in for the libc one
+class TermOutput {
+public:
+    static size_t get_bytes_written(); // to stdout since startup
+};
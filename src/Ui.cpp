@@ -2,25 +2,64 @@
 
 Ui::Ui(std::vector<std::string> args_)
 :   args(args_),
-    config("/home/canoe/.config/cadence/conf.toml"),
+    config_path(Config::default_path()),
+    config(config_path),
     database(&config),
-    week(&database, &config)
+    week(&database, &config),
+    overview(&database, &config),
+    agenda(&database, &config),
+    scheduler(&database, &config),
+    templates(&database, &config),
+    search_index(config.save_path),
+    input(STDIN_FILENO),
+    config_watcher(config_path)
 {
     current_mode = MD_WEEK;
-    key_sequence = "";
-    time_since_last_key = 0;
+    rename_text = "";
+    notice = "";
+    search_pos = 0;
+    search_origin_day = search_origin_id = 0;
+    template_command = Config::CMD_NONE;
+    template_count = 0;
+    template_prompt = "";
+    build_keymaps(config, keymaps);
+
+    quitting = false;
+    redraw = true;
+    minute_timer_fd = winch_fd = -1;
+
+    bar_win = nullptr;
+    last_bar_state = "";
+    bytes_written = last_frame_bytes = frame_count = 0;
 }
 
 //public
 void Ui::main() {
     if (args.size() == 1) {
         init_ncurses();
+        init_events();
+
+        // sleep until a key, the minute tick or a resize, and only then draw
+        while (!quitting) {
+            if (redraw) draw();
+            redraw = false;
 
-        while (true) if (draw_cycle()) break;
+            events.wait(get_wait_timeout());
+
+            // a stale sequence is dropped, or run if it is a whole binding
+            Keymap::en_result expired = keymaps[current_mode].expire();
+            if (expired != Keymap::KM_PENDING) {
+                redraw = true;
+                notice = "";
+                if (handle_result(expired)) quitting = true;
+            }
+        }
 
+        input.stop();
         endwin();
 
         week.dump_info();
+        dump_render_stats();
     } else {
         for (std::string str : args) {
             std::cout << str << std::endl;
@@ -34,8 +73,7 @@ void Ui::init_ncurses() {
     initscr(); // sets up mem and clears screen
     curs_set(0); // hides cursor
     cbreak(); // ^C exits program
-    nodelay(stdscr, true); // getch() is non blocking now
-    keypad(stdscr, true); // detect special keys like arrows
+    keypad(stdscr, true); // sends the keypad init sequence, arrows are decoded by Input
     noecho(); // don't write what you type to the screen
 
     if (!has_colors()) throw std::runtime_error("terminal doesn't support colors");
@@ -54,189 +92,857 @@ void Ui::init_ncurses() {
     // black foreground, colored background
     init_pair(16, 0, 15);
     for (int i = 1; i < 8; i++) init_pair(i+16, 0, i);
+
+    resize();
+}
+
+// private
+void Ui::init_events() {
+    // the today cursor moves once a minute, so wake up on every minute boundary
+    minute_timer_fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (minute_timer_fd < 0) throw std::runtime_error("unable to create minute timer");
+
+    struct itimerspec minute_spec = {};
+    minute_spec.it_value.tv_sec = (time(0) / 60 + 1) * 60;
+    minute_spec.it_interval.tv_sec = 60;
+    timerfd_settime(minute_timer_fd, TFD_TIMER_ABSTIME, &minute_spec, nullptr);
+
+    events.add_fd(minute_timer_fd, [this]() {
+        uint64_t expirations;
+        while (read(minute_timer_fd, &expirations, sizeof(expirations)) > 0) {}
+        redraw = true;
+    });
+
+    // terminal resizes come in thru a signalfd instead of ncurses' handler
+    sigset_t winch_set;
+    sigemptyset(&winch_set);
+    sigaddset(&winch_set, SIGWINCH);
+    pthread_sigmask(SIG_BLOCK, &winch_set, nullptr);
+
+    winch_fd = signalfd(-1, &winch_set, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (winch_fd < 0) throw std::runtime_error("unable to watch for terminal resizes");
+
+    events.add_fd(winch_fd, [this]() {
+        struct signalfd_siginfo info;
+        while (read(winch_fd, &info, sizeof(info)) > 0) {}
+
+        sync_terminal_size();
+        redraw = true;
+    });
+
+    // config edits are parsed in the background and swapped in between frames
+    events.add_fd(config_watcher.get_change_fd(), [this]() { config_watcher.handle_changes(); });
+    events.add_fd(config_watcher.get_ready_fd(), [this]() { reload_config(); });
+
+    // block files written here or elsewhere are indexed again for search
+    events.add_fd(search_index.get_change_fd(), [this]() {
+        if (search_index.handle_changes() && current_mode == MD_SEARCH) {
+            update_search();
+            redraw = true;
+        }
+    });
+
+    // keys, the reader thread is started after SIGWINCH is blocked so it inherits the mask
+    events.add_fd(input.get_notify_fd(), [this]() { read_input(); });
+    input.start();
+}
+
+// private
+void Ui::read_input() {
+    input.clear_notification();
+
+    // everything typed since the last wake is handled before the next frame
+    Input::key_event event;
+    while (input.pop(event)) pending_keys.push_back(event.key);
+
+    while (!pending_keys.empty()) {
+        int key = pending_keys.front();
+        pending_keys.pop_front();
+        redraw = true;
+
+        if (handle_key(key)) {
+            quitting = true;
+            pending_keys.clear();
+            return;
+        }
+    }
+}
+
+// private
+int Ui::take_repeats(const std::vector<int>& keys) {
+    int repeats = 0;
+
+    // a held key queues the same sequence over and over, fold those into one edit
+    while (pending_keys.size() >= keys.size()
+           && std::equal(keys.begin(), keys.end(), pending_keys.begin())) {
+        pending_keys.erase(pending_keys.begin(), pending_keys.begin() + keys.size());
+        repeats++;
+    }
+
+    return repeats;
+}
+
+// private
+void Ui::build_keymaps(const Config& cfg, Keymap* maps) {
+    // week mode takes counts, and unfinished sequences time out
+    maps[MD_WEEK] = Keymap(true, cfg.key_timeout);
+    for (int command = 0; command <= Config::CMD_LAST_WEEK; command++)
+        bind_keys(maps[MD_WEEK], cfg, command);
+
+    // while renaming anything that isn't bound is text, so nothing times out
+    maps[MD_WEEK_RENAME] = Keymap(false, -1);
+    for (int command = Config::CMD_CONFIRM_RENAME; command <= Config::CMD_CLEAR_RENAME; command++)
+        bind_keys(maps[MD_WEEK_RENAME], cfg, command);
+
+    // and so is naming a template
+    maps[MD_TEMPLATE] = Keymap(false, -1);
+    for (int command = Config::CMD_CONFIRM_RENAME; command <= Config::CMD_CLEAR_RENAME; command++)
+        bind_keys(maps[MD_TEMPLATE], cfg, command);
+
+    // or a date to go to
+    maps[MD_GO_TO] = Keymap(false, -1);
+    for (int command = Config::CMD_CONFIRM_RENAME; command <= Config::CMD_CLEAR_RENAME; command++)
+        bind_keys(maps[MD_GO_TO], cfg, command);
+
+    // searching is typing too, with keys to go thru the results
+    maps[MD_SEARCH] = Keymap(false, -1);
+    for (int command = Config::CMD_CONFIRM_RENAME; command <= Config::CMD_SEARCH_PREV; command++)
+        bind_keys(maps[MD_SEARCH], cfg, command);
+
+    // selecting moves the focus like the week does, the edits go to every selected block
+    maps[MD_VISUAL] = Keymap(true, cfg.key_timeout);
+    for (int command : { Config::CMD_LEFT, Config::CMD_UP, Config::CMD_DOWN, Config::CMD_RIGHT,
+                         Config::CMD_MOVE_UP, Config::CMD_MOVE_DOWN,
+                         Config::CMD_MOVE_RIGHT, Config::CMD_MOVE_LEFT,
+                         Config::CMD_COPY_LEFT, Config::CMD_COPY_RIGHT,
+                         Config::CMD_COPY_DOWN, Config::CMD_COPY_UP,
+                         Config::CMD_TOGGLE_IMPORTANT, Config::CMD_TOGGLE_COLLAPSIBLE,
+                         Config::CMD_REMOVE, Config::CMD_VISUAL, Config::CMD_CANCEL_RENAME })
+        bind_keys(maps[MD_VISUAL], cfg, command);
+    for (int command = Config::CMD_SET_COL_WHITE; command <= Config::CMD_SET_COL_GRAY; command++)
+        bind_keys(maps[MD_VISUAL], cfg, command);
+
+    // the overview moves around like the week does
+    maps[MD_OVERVIEW] = Keymap(true, cfg.key_timeout);
+    for (int command : { Config::CMD_QUIT, Config::CMD_LEFT, Config::CMD_UP, Config::CMD_DOWN,
+                         Config::CMD_RIGHT, Config::CMD_MONTH_VIEW, Config::CMD_YEAR_VIEW,
+                         Config::CMD_OPEN_DAY, Config::CMD_CLOSE_OVERVIEW })
+        bind_keys(maps[MD_OVERVIEW], cfg, command);
+
+    // and so does the agenda, a line at a time
+    maps[MD_AGENDA] = Keymap(true, cfg.key_timeout);
+    for (int command : { Config::CMD_QUIT, Config::CMD_LEFT, Config::CMD_UP, Config::CMD_DOWN,
+                         Config::CMD_RIGHT, Config::CMD_SCROLL_UP, Config::CMD_SCROLL_DOWN,
+                         Config::CMD_AGENDA, Config::CMD_OPEN_DAY, Config::CMD_CLOSE_OVERVIEW })
+        bind_keys(maps[MD_AGENDA], cfg, command);
+}
+
+// private
+void Ui::bind_keys(Keymap& keymap, const Config& cfg, int command) {
+    int other = keymap.bind(cfg.keybinds[command], command);
+    if (other != -1 && other != command) throw std::runtime_error(cfg.conflict_str(command, other));
+}
+
+// private
+void Ui::reload_config() {
+    std::unique_ptr<Config> fresh;
+    std::string error;
+    if (!config_watcher.take_result(fresh, error)) return;
+
+    redraw = true;
+
+    // keybinds that clash are an error like any other, checked before anything changes
+    Keymap fresh_keymaps[MD_COUNT];
+    if (fresh != nullptr) {
+        try {
+            build_keymaps(*fresh, fresh_keymaps);
+        } catch (const std::runtime_error& err) {
+            fresh = nullptr;
+            error = err.what();
+        }
+    }
+
+    if (fresh == nullptr) { // keep running on the old config
+        std::replace(error.begin(), error.end(), '\n', ' ');
+        notice = "config not reloaded: " + error;
+        return;
+    }
+
+    // only what depends on the changed sections is rebuilt, the database stays as it is
+    int changed = config.update(*fresh);
+    week.apply_config(changed);
+    overview.invalidate();
+    agenda.invalidate();
+    if (changed & Config::SEC_KEYS) std::copy(fresh_keymaps, fresh_keymaps + MD_COUNT, keymaps);
+    if (changed & Config::SEC_LAYOUT) resize(); // the gaps between days moved
+
+    notice = "config reloaded";
+    if (changed & Config::SEC_RESTART) notice += " (save path and block formats need a restart)";
+}
+
+// private
+int Ui::get_wait_timeout() const {
+    int remaining = keymaps[current_mode].get_ms_until_timeout();
+    return (remaining < 0)? -1 : remaining + 1;
+}
+
+// private
+void Ui::resize() {
+    int height, width; getmaxyx(stdscr, height, width);
+
+    // stdscr is only used for the gaps between days, so it just needs clearing
+    werase(stdscr);
+    wnoutrefresh(stdscr);
+
+    if (bar_win != nullptr) delwin(bar_win);
+    bar_win = newwin(1, width, height - 1, 0);
+    last_bar_state = "";
+
+    week.invalidate();
+    overview.invalidate();
+    agenda.invalidate();
+}
+
+// private
+void Ui::repaint() { clearok(curscr, true); } // after other programs used the terminal
+
+// private
+void Ui::run_external(std::function<void()> action) {
+    // children inherit the signal mask, and an editor that never hears of resizes
+    // doesn't follow them, so SIGWINCH is only blocked (for the signalfd) around it
+    sigset_t winch_set;
+    sigemptyset(&winch_set);
+    sigaddset(&winch_set, SIGWINCH);
+
+    // the other program gets the keys until it exits
+    input.pause();
+    pthread_sigmask(SIG_UNBLOCK, &winch_set, nullptr);
+    action();
+    pthread_sigmask(SIG_BLOCK, &winch_set, nullptr);
+    input.resume();
+
+    sync_terminal_size(); // resizes meanwhile didn't come thru the signalfd
+    repaint();
 }
 
 // private
-bool Ui::draw_cycle() {
-    wclear(stdscr);
+void Ui::sync_terminal_size() {
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0)
+        resizeterm(size.ws_row, size.ws_col);
 
+    resize();
+}
+
+// private
+void Ui::draw() {
     int height, width; getmaxyx(stdscr, height, width);
 
-    week.draw(height - 1, width, 0, 0);
+    // only the windows that changed are redrawn, then sent in one update
+    if (current_mode == MD_OVERVIEW) overview.draw(height - 1, width, 0, 0);
+    else if (current_mode == MD_AGENDA) agenda.draw(height - 1, width, 0, 0);
+    else week.draw(height - 1, width, 0, 0);
     draw_bottom_bar(height, width);
 
-    wrefresh(stdscr);
+    size_t bytes_before = TermOutput::get_bytes_written();
+    doupdate();
+    size_t frame_bytes = TermOutput::get_bytes_written() - bytes_before;
+
+    if (frame_bytes != 0) {
+        bytes_written += frame_bytes;
+        last_frame_bytes = frame_bytes;
+        frame_count++;
+    }
+}
+
+// private
+bool Ui::handle_key(int key) {
+    notice = "";
 
-    char key = getch();
+    Keymap& keymap = keymaps[current_mode];
+    if (handle_result(keymap.feed(key))) return true;
 
-    if (key == ERR) {
-        if (time_since_last_key > config.num({"keybinds", "timeout"})
-         && current_mode != MD_WEEK_RENAME) { // we are typing for long in week_rename so no timeout
-            key_sequence = "";
+    // a key that ended a shorter binding early starts the next one, in whatever mode it left
+    int held;
+    if (keymap.take_held_key(held)) return handle_key(held);
+
+    return false;
+}
+
+// private
+bool Ui::handle_result(Keymap::en_result result) {
+    Keymap& keymap = keymaps[current_mode];
+
+    if (current_mode == MD_WEEK_RENAME) {
+        if (result == Keymap::KM_MATCH) run_rename_command(keymap.get_command());
+        else if (result == Keymap::KM_REJECT) type_rename_keys(keymap.get_keys());
+
+        return false;
+    }
+
+    if (current_mode == MD_TEMPLATE) {
+        if (result == Keymap::KM_MATCH) run_template_command(keymap.get_command());
+        else if (result == Keymap::KM_REJECT) type_rename_keys(keymap.get_keys());
+
+        return false;
+    }
+
+    if (current_mode == MD_GO_TO) {
+        if (result == Keymap::KM_MATCH) run_go_to_command(keymap.get_command());
+        else if (result == Keymap::KM_REJECT) type_rename_keys(keymap.get_keys());
+
+        return false;
+    }
+
+    if (current_mode == MD_SEARCH) {
+        if (result == Keymap::KM_MATCH) run_search_command(keymap.get_command());
+        else if (result == Keymap::KM_REJECT) {
+            type_rename_keys(keymap.get_keys());
+            update_search();
         }
 
-        napms(config.num({"ui", "frame_time"}));
-        time_since_last_key += config.num({"ui", "frame_time"});
         return false;
     }
 
-    time_since_last_key = 0;
-
-    switch (key) { // update key_sequence with appropriate escape, or just the char
-        case 4:  key_sequence += "<left>";  break;
-        case 3:  key_sequence += "<up>";    break;
-        case 2:  key_sequence += "<down>";  break;
-        case 5:  key_sequence += "<right>"; break;
-        case 7:  key_sequence += "<bs>";    break;
-        case 10: key_sequence += "<cr>";    break;
-        case 9:  key_sequence += "<tab>";   break;
-        case 27: key_sequence += "<esc>";   break;
-        case 18: key_sequence += "<c-r>";   break;
-        default: key_sequence += key;       break;
+    if (result != Keymap::KM_MATCH) return false;
+
+    if (current_mode == MD_OVERVIEW) {
+        if (keymap.get_command() == Config::CMD_QUIT) return true;
+
+        run_overview_command(keymap.get_command(), keymap.get_count());
+        return false;
     }
 
-    std::string sequence = key_sequence;
-    key_sequence = "";
+    if (current_mode == MD_AGENDA) {
+        if (keymap.get_command() == Config::CMD_QUIT) return true;
 
-    switch(current_mode) {
-        case MD_WEEK:
+        run_agenda_command(keymap.get_command(), keymap.get_count());
+        return false;
+    }
 
-            if (sequence == config.str({"keybinds", "quit"}))
-                return true;
-
-            else if (sequence == config.str({"keybinds", "left"}))
-                week.move_focus(-1);
-            else if (sequence == config.str({"keybinds", "up"}))
-                week.move_block_focus(-1);
-            else if (sequence == config.str({"keybinds", "down"}))
-                week.move_block_focus(1);
-            else if (sequence == config.str({"keybinds", "right"}))
-                week.move_focus(1);
-
-            else if (sequence == config.str({"keybinds", "week", "rename"})) {
-                if (week.block_focused()) {
-                    current_mode = MD_WEEK_RENAME;
-                    // key_sequence = week.get_focused_block().get_title();
-                }
-            }
+    if (current_mode == MD_VISUAL) {
+        if (!run_visual_command(keymap.get_command(), keymap.get_count(), keymap.get_keys()))
+            notice = "no room for the selection there";
 
-            else if (sequence == config.str({"keybinds", "week", "new_block_below"})) {
-                if (week.new_block_below()) { // returns success state
-                    current_mode = MD_WEEK_RENAME;
-                }
-            }
-            else if (sequence == config.str({"keybinds", "week", "new_block_above"})) {
-                if (week.new_block_above()) { // returns success state
-                    current_mode = MD_WEEK_RENAME;
-                }
-            }
+        return false;
+    }
 
-            else if (sequence == config.str({"keybinds", "week", "move_up"}))
-                week.move_block_up();
-            else if (sequence == config.str({"keybinds", "week", "move_down"}))
-                week.move_block_down();
-            else if (sequence == config.str({"keybinds", "week", "move_right"}))
-                week.move_block_right();
-            else if (sequence == config.str({"keybinds", "week", "move_left"}))
-                week.move_block_left();
-
-            else if (sequence == config.str({"keybinds", "week", "extend_top_up"}))
-                week.extend_top_up();
-            else if (sequence == config.str({"keybinds", "week", "extend_top_down"}))
-                week.extend_top_down();
-            else if (sequence == config.str({"keybinds", "week", "extend_bottom_up"}))
-                week.extend_bottom_up();
-            else if (sequence == config.str({"keybinds", "week", "extend_bottom_down"}))
-                week.extend_bottom_down();
-
-            else if (sequence == config.str({"keybinds", "week", "move_up_snap"}))
-                while(week.move_block_up()) {}
-            else if (sequence == config.str({"keybinds", "week", "move_down_snap"}))
-                while(week.move_block_down()) {}
-            else if (sequence == config.str({"keybinds", "week", "extend_top_up_snap"}))
-                while(week.extend_top_up()) {}
-            else if (sequence == config.str({"keybinds", "week", "extend_bottom_down_snap"}))
-                while(week.extend_bottom_down()) {}
-
-            else if (sequence == config.str({"keybinds", "week", "set_col_white"}))
-                week.set_block_color("white");
-            else if (sequence == config.str({"keybinds", "week", "set_col_red"}))
-                week.set_block_color("red");
-            else if (sequence == config.str({"keybinds", "week", "set_col_green"}))
-                week.set_block_color("green");
-            else if (sequence == config.str({"keybinds", "week", "set_col_yellow"}))
-                week.set_block_color("yellow");
-            else if (sequence == config.str({"keybinds", "week", "set_col_blue"}))
-                week.set_block_color("blue");
-            else if (sequence == config.str({"keybinds", "week", "set_col_purple"}))
-                week.set_block_color("purple");
-            else if (sequence == config.str({"keybinds", "week", "set_col_aqua"}))
-                week.set_block_color("aqua");
-            else if (sequence == config.str({"keybinds", "week", "set_col_gray"}))
-                week.set_block_color("gray");
-
-            else if (sequence == config.str({"keybinds", "week", "toggle_important"}))
-                week.block_toggle_important();
-            else if (sequence == config.str({"keybinds", "week", "toggle_collapsible"}))
-                week.block_toggle_collapsible();
-
-            else if (sequence == config.str({"keybinds", "week", "edit_block_source"}))
-                week.edit_block_source();
-            else if (sequence == config.str({"keybinds", "week", "follow_link"}))
-                week.follow_link();
-
-            else if (sequence == config.str({"keybinds", "week", "copy_left"}))
-                week.copy_block_lateral(-1);
-            else if (sequence == config.str({"keybinds", "week", "copy_right"}))
-                week.copy_block_lateral(1);
-            else if (sequence == config.str({"keybinds", "week", "copy_down"}))
-                week.copy_block_vertical(true);
-            else if (sequence == config.str({"keybinds", "week", "copy_up"}))
-                week.copy_block_vertical(false);
-
-            else if (sequence == config.str({"keybinds", "week", "undo"}))
-                week.undo();
-            else if (sequence == config.str({"keybinds", "week", "redo"}))
-                week.redo();
-
-            else if (sequence == config.str({"keybinds", "week", "remove"}))
-                week.remove_block();
-
-            else if (sequence == config.str({"keybinds", "week", "reload"}))
-                week.reload_all();
-
-            else key_sequence = sequence;
+    return run_command(keymap.get_command(), keymap.get_count(), keymap.get_counted(),
+                       keymap.get_keys());
+}
 
+// private
+bool Ui::run_command(int command, int count, bool counted, const std::vector<int>& keys) {
+    switch (command) {
+        case Config::CMD_QUIT:
+            return true;
+
+        case Config::CMD_LEFT:  week.move_focus(-count);       break;
+        case Config::CMD_UP:    week.move_block_focus(-count); break;
+        case Config::CMD_DOWN:  week.move_block_focus(count);  break;
+        case Config::CMD_RIGHT: week.move_focus(count);        break;
+
+        case Config::CMD_RENAME:
+            if (week.block_focused()) enter_rename();
+            break;
+        case Config::CMD_NEW_BLOCK_BELOW:
+            if (week.new_block_below()) enter_rename(); // returns success state
+            break;
+        case Config::CMD_NEW_BLOCK_ABOVE:
+            if (week.new_block_above()) enter_rename(); // returns success state
             break;
-        case MD_WEEK_RENAME:
 
-            size_t confirm_pos = sequence.find(config.str({"keybinds", "week", "confirm_rename"}));
-            size_t cancel_pos = sequence.find(config.str({"keybinds", "week", "cancel_rename"}));
-            size_t clear_pos = sequence.find(config.str({"keybinds", "week", "clear_rename"}));
-            size_t bs_pos = sequence.find("<bs>");
+        case Config::CMD_MOVE_UP:   week.move_block_up(count + take_repeats(keys));   break;
+        case Config::CMD_MOVE_DOWN: week.move_block_down(count + take_repeats(keys)); break;
+        case Config::CMD_MOVE_RIGHT: week.move_block_right(); break;
+        case Config::CMD_MOVE_LEFT:  week.move_block_left();  break;
 
-            if (confirm_pos != std::string::npos) {
-                week.rename_block(sequence.substr(0, confirm_pos));
-                current_mode = MD_WEEK;
-            }
-            else if (cancel_pos != std::string::npos)
-                current_mode = MD_WEEK;
-            else if (clear_pos != std::string::npos)
-                key_sequence = "";
-            else if (bs_pos != std::string::npos) {
-                if (bs_pos > 0) key_sequence = sequence.substr(0, bs_pos - 1);
-                else key_sequence = "";
-            }
-            else key_sequence = sequence;
+        case Config::CMD_EXTEND_TOP_UP:
+            week.extend_top_up(count + take_repeats(keys)); break;
+        case Config::CMD_EXTEND_TOP_DOWN:
+            week.extend_top_down(count + take_repeats(keys)); break;
+        case Config::CMD_EXTEND_BOTTOM_UP:
+            week.extend_bottom_up(count + take_repeats(keys)); break;
+        case Config::CMD_EXTEND_BOTTOM_DOWN:
+            week.extend_bottom_down(count + take_repeats(keys)); break;
+
+        case Config::CMD_MOVE_UP_SNAP:   week.move_block_up(Database::SNAP_MINUTES);   break;
+        case Config::CMD_MOVE_DOWN_SNAP: week.move_block_down(Database::SNAP_MINUTES); break;
+        case Config::CMD_EXTEND_TOP_UP_SNAP:
+            week.extend_top_up(Database::SNAP_MINUTES); break;
+        case Config::CMD_EXTEND_BOTTOM_DOWN_SNAP:
+            week.extend_bottom_down(Database::SNAP_MINUTES); break;
+
+        case Config::CMD_SET_COL_WHITE:  week.set_block_color("white");  break;
+        case Config::CMD_SET_COL_RED:    week.set_block_color("red");    break;
+        case Config::CMD_SET_COL_GREEN:  week.set_block_color("green");  break;
+        case Config::CMD_SET_COL_YELLOW: week.set_block_color("yellow"); break;
+        case Config::CMD_SET_COL_BLUE:   week.set_block_color("blue");   break;
+        case Config::CMD_SET_COL_PURPLE: week.set_block_color("purple"); break;
+        case Config::CMD_SET_COL_AQUA:   week.set_block_color("aqua");   break;
+        case Config::CMD_SET_COL_GRAY:   week.set_block_color("gray");   break;
+
+        case Config::CMD_TOGGLE_IMPORTANT:   week.block_toggle_important();   break;
+        case Config::CMD_TOGGLE_COLLAPSIBLE: week.block_toggle_collapsible(); break;
+
+        case Config::CMD_EDIT_BLOCK_SOURCE:
+            run_external([this]() { week.edit_block_source(); }); break;
+        case Config::CMD_FOLLOW_LINK:
+            run_external([this]() { week.follow_link(); }); break;
+
+        case Config::CMD_COPY_LEFT:  week.copy_block_lateral(-1);     break;
+        case Config::CMD_COPY_RIGHT: week.copy_block_lateral(1);      break;
+        case Config::CMD_COPY_DOWN:  week.copy_block_vertical(true);  break;
+        case Config::CMD_COPY_UP:    week.copy_block_vertical(false); break;
+
+        case Config::CMD_UNDO: week.undo(); break;
+        case Config::CMD_REDO: week.redo(); break;
 
+        case Config::CMD_REMOVE: week.remove_block(); break;
+        case Config::CMD_RELOAD: week.reload_all();   break;
+
+        case Config::CMD_RIPPLE_BELOW:
+            if (week.ripple_insert_below()) enter_rename(); // returns success state
+            break;
+        case Config::CMD_RIPPLE_ABOVE:
+            if (week.ripple_insert_above()) enter_rename(); // returns success state
+            break;
+        case Config::CMD_RIPPLE_REMOVE: week.ripple_remove(); break;
+
+        case Config::CMD_NEW_BLOCK_BESIDE:
+            if (week.new_block_beside()) enter_rename(); // returns success state
+            else notice = "no free track beside this block";
+            break;
+
+        case Config::CMD_ZOOM_IN:  week.zoom_by(count);  break;
+        case Config::CMD_ZOOM_OUT: week.zoom_by(-count); break;
+        case Config::CMD_ZOOM_FIT: week.zoom_fit();      break;
+
+        case Config::CMD_SCROLL_UP:    week.scroll_vertical(-count - take_repeats(keys)); break;
+        case Config::CMD_SCROLL_DOWN:  week.scroll_vertical(count + take_repeats(keys));  break;
+        case Config::CMD_SCROLL_LEFT:  week.scroll_lateral(-count - take_repeats(keys));  break;
+        case Config::CMD_SCROLL_RIGHT: week.scroll_lateral(count + take_repeats(keys));   break;
+
+        case Config::CMD_SCHEDULE: schedule_tasks(); break;
+        case Config::CMD_SEARCH:   enter_search();   break;
+        case Config::CMD_VISUAL:   enter_visual();   break;
+
+        case Config::CMD_SAVE_DAY_TEMPLATE:
+        case Config::CMD_SAVE_WEEK_TEMPLATE:
+        case Config::CMD_APPLY_TEMPLATE:
+            enter_template(command, count);
             break;
+
+        case Config::CMD_AGENDA: open_agenda(); break;
+
+        case Config::CMD_GO_TO_DATE:     enter_go_to();                   break;
+        // without a count, a slot a new block would fit in
+        case Config::CMD_NEXT_FREE_SLOT:
+        case Config::CMD_PREV_FREE_SLOT:
+            jump_to_free_slot(counted? count : config.default_block_duration / 60,
+                              command == Config::CMD_PREV_FREE_SLOT);
+            break;
+
+        case Config::CMD_NEXT_IMPORTANT:
+        case Config::CMD_PREV_IMPORTANT:
+        case Config::CMD_NEXT_SAME_COLOR:
+        case Config::CMD_PREV_SAME_COLOR:
+        case Config::CMD_NEXT_SAME_TITLE:
+        case Config::CMD_PREV_SAME_TITLE:
+            jump_to_match(command, count);
+            break;
+
+        case Config::CMD_MONTH_VIEW: open_overview(Overview::SCALE_MONTH); break;
+        case Config::CMD_YEAR_VIEW:  open_overview(Overview::SCALE_YEAR);  break;
     }
 
     return false;
 }
 
+// private
+void Ui::enter_rename() {
+    current_mode = MD_WEEK_RENAME;
+    rename_text = "";
+    keymaps[MD_WEEK_RENAME].reset();
+}
+
+// private
+void Ui::schedule_tasks() {
+    int first_day = week.get_focus_day();
+    std::vector<Scheduler::task> tasks, unplaced;
+
+    try {
+        tasks = scheduler.read_tasks(config.tasks_path, first_day);
+    } catch (const std::runtime_error& err) {
+        notice = std::string("schedule: ") + err.what();
+        return;
+    }
+
+    unplaced = scheduler.schedule(tasks, first_day, config.schedule_days);
+    week.reload_all();
+
+    notice = "scheduled " + std::to_string(tasks.size() - unplaced.size())
+           + " of " + std::to_string(tasks.size()) + " tasks";
+
+    for (size_t i = 0; i < unplaced.size(); i++)
+        notice += (i == 0? ", no room for: " : ", ") + unplaced[i].title;
+}
+
+// private
+void Ui::open_overview(Overview::en_scale scale) {
+    overview.open(scale, week.get_focus_day());
+    overview.invalidate();
+    current_mode = MD_OVERVIEW;
+}
+
+// private
+void Ui::run_overview_command(int command, int count) {
+    switch (command) {
+        case Config::CMD_LEFT:  overview.move_focus(-count);      break;
+        case Config::CMD_UP:    overview.move_focus_rows(-count); break;
+        case Config::CMD_DOWN:  overview.move_focus_rows(count);  break;
+        case Config::CMD_RIGHT: overview.move_focus(count);       break;
+
+        case Config::CMD_MONTH_VIEW:
+            overview.open(Overview::SCALE_MONTH, overview.get_focused_day()); break;
+        case Config::CMD_YEAR_VIEW:
+            overview.open(Overview::SCALE_YEAR, overview.get_focused_day()); break;
+
+        case Config::CMD_OPEN_DAY:
+            week.focus_day(overview.get_focused_day());
+            [[fallthrough]];
+        case Config::CMD_CLOSE_OVERVIEW:
+            current_mode = MD_WEEK;
+            resize(); // the overview covered the gaps between days
+            break;
+    }
+}
+
+// private
+void Ui::open_agenda() {
+    if (week.block_focused()) agenda.open(week.get_focused_block().get_time_t_start());
+    else agenda.open(Calendar::midnight(week.get_focus_day()));
+
+    agenda.invalidate();
+    current_mode = MD_AGENDA;
+}
+
+// private
+void Ui::run_agenda_command(int command, int count) {
+    switch (command) {
+        case Config::CMD_LEFT:  agenda.move_focus_days(-count); break;
+        case Config::CMD_UP:    agenda.move_focus(-count);      break;
+        case Config::CMD_DOWN:  agenda.move_focus(count);       break;
+        case Config::CMD_RIGHT: agenda.move_focus_days(count);  break;
+
+        case Config::CMD_SCROLL_UP:   agenda.scroll_pages(-count); break;
+        case Config::CMD_SCROLL_DOWN: agenda.scroll_pages(count);  break;
+
+        case Config::CMD_OPEN_DAY:
+            if (agenda.has_focus()) {
+                Block block = agenda.get_focused_block();
+                week.focus_block(block.get_day(), block.get_id());
+            }
+            else week.focus_day(agenda.get_focused_day());
+            [[fallthrough]];
+        case Config::CMD_AGENDA:
+        case Config::CMD_CLOSE_OVERVIEW:
+            current_mode = MD_WEEK;
+            resize(); // the agenda covered the gaps between days
+            break;
+    }
+}
+
+// private
+void Ui::enter_template(int command, int count) {
+    current_mode = MD_TEMPLATE;
+    template_command = command;
+    template_count = count;
+    rename_text = "";
+    keymaps[MD_TEMPLATE].reset();
+
+    if (command == Config::CMD_SAVE_DAY_TEMPLATE) template_prompt = "save day as: ";
+    else if (command == Config::CMD_SAVE_WEEK_TEMPLATE) template_prompt = "save week as: ";
+    else { // read once here, not on every frame
+        std::vector<std::string> names = templates.list();
+        template_prompt = "apply";
+
+        for (size_t i = 0; i < names.size(); i++)
+            template_prompt += (i == 0? " (" : ", ") + names[i];
+
+        template_prompt += names.empty()? ": " : "): ";
+    }
+}
+
+// private
+void Ui::run_template_command(int command) {
+    if (command == Config::CMD_CLEAR_RENAME) {
+        rename_text = "";
+        return;
+    }
+
+    current_mode = MD_WEEK;
+    if (command != Config::CMD_CONFIRM_RENAME) return;
+
+    int day = week.get_focus_day();
+
+    try {
+        if (template_command == Config::CMD_SAVE_DAY_TEMPLATE) {
+            int count = templates.capture(rename_text, day, 1);
+            notice = "saved " + std::to_string(count) + " blocks as " + rename_text;
+        } else if (template_command == Config::CMD_SAVE_WEEK_TEMPLATE) {
+            int monday = day - (Calendar::weekday(day) + 6) % 7;
+            int count = templates.capture(rename_text, monday, 7);
+            notice = "saved " + std::to_string(count) + " blocks as " + rename_text;
+        } else {
+            int total;
+            int added = templates.apply(rename_text, day, template_count, total);
+            week.reload_all();
+
+            notice = "applied " + rename_text + ", " + std::to_string(added) + " of "
+                   + std::to_string(total) + " blocks fit";
+        }
+    } catch (const std::runtime_error& err) {
+        notice = std::string("template: ") + err.what();
+    }
+}
+
+// private
+void Ui::enter_go_to() {
+    current_mode = MD_GO_TO;
+    rename_text = "";
+    keymaps[MD_GO_TO].reset();
+}
+
+// private
+void Ui::run_go_to_command(int command) {
+    if (command == Config::CMD_CLEAR_RENAME) {
+        rename_text = "";
+        return;
+    }
+
+    current_mode = MD_WEEK;
+    if (command != Config::CMD_CONFIRM_RENAME) return;
+
+    // dates without their year land within half a year of today, either way
+    int day;
+    if (Calendar::parse_date(rename_text, config.date_format,
+                             Calendar::add_months(Calendar::today(), -6), day))
+        week.focus_day(day);
+    else notice = "invalid date: " + rename_text;
+}
+
+// private
+void Ui::jump_to_match(int command, int count) {
+    bool backward = command == Config::CMD_PREV_IMPORTANT
+                 || command == Config::CMD_PREV_SAME_COLOR
+                 || command == Config::CMD_PREV_SAME_TITLE;
+    Database::en_match match = Database::MATCH_TITLE;
+    std::string what = "block with this title";
+
+    if (command == Config::CMD_NEXT_IMPORTANT || command == Config::CMD_PREV_IMPORTANT) {
+        match = Database::MATCH_IMPORTANT;
+        what = "important block";
+    } else if (command == Config::CMD_NEXT_SAME_COLOR || command == Config::CMD_PREV_SAME_COLOR) {
+        match = Database::MATCH_COLOR;
+        what = "block with this color";
+    }
+
+    // stops at the last one there is, only the day it lands on is built
+    if (!week.jump_to_match(match, backward, count))
+        notice = std::string("no ") + (backward? "earlier " : "later ") + what;
+}
+
+// private
+void Ui::jump_to_free_slot(int minutes, bool backward) {
+    time_t slot = week.jump_to_free_slot(minutes, backward);
+    if (slot < 0) {
+        notice = "no " + std::to_string(minutes) + " free minutes within a year";
+        return;
+    }
+
+    char date[64];
+    struct tm start; localtime_r(&slot, &start);
+    std::string format = config.day_format + " " + config.date_format + " %H:%M";
+    std::strftime(date, sizeof(date), format.c_str(), &start);
+
+    notice = std::to_string(minutes) + " minutes free from " + date;
+}
+
+// private
+void Ui::enter_visual() {
+    week.start_selection();
+    current_mode = MD_VISUAL;
+    keymaps[MD_VISUAL].reset();
+}
+
+// private
+bool Ui::run_visual_command(int command, int count, const std::vector<int>& keys) {
+    static const std::string color_names[] = {
+        "white", "red", "green", "yellow", "blue", "purple", "aqua", "gray" };
+
+    bool done = true; // edits other than moves end the selection
+    bool fits = true;
+
+    switch (command) {
+        case Config::CMD_LEFT:  week.move_focus(-count);       done = false; break;
+        case Config::CMD_UP:    week.move_block_focus(-count); done = false; break;
+        case Config::CMD_DOWN:  week.move_block_focus(count);  done = false; break;
+        case Config::CMD_RIGHT: week.move_focus(count);        done = false; break;
+
+        case Config::CMD_MOVE_UP:
+            fits = week.shift_selection(0, -count - take_repeats(keys)); done = false; break;
+        case Config::CMD_MOVE_DOWN:
+            fits = week.shift_selection(0, count + take_repeats(keys));  done = false; break;
+        case Config::CMD_MOVE_RIGHT:
+            fits = week.shift_selection(count, 0);  done = false; break;
+        case Config::CMD_MOVE_LEFT:
+            fits = week.shift_selection(-count, 0); done = false; break;
+
+        case Config::CMD_COPY_LEFT:  fits = week.copy_selection_lateral(-count);    break;
+        case Config::CMD_COPY_RIGHT: fits = week.copy_selection_lateral(count);     break;
+        case Config::CMD_COPY_DOWN:  fits = week.copy_selection_vertical(true);     break;
+        case Config::CMD_COPY_UP:    fits = week.copy_selection_vertical(false);    break;
+
+        case Config::CMD_TOGGLE_IMPORTANT:   week.toggle_selection_important();   break;
+        case Config::CMD_TOGGLE_COLLAPSIBLE: week.toggle_selection_collapsible(); break;
+        case Config::CMD_REMOVE:             week.remove_selection();             break;
+
+        case Config::CMD_VISUAL:
+        case Config::CMD_CANCEL_RENAME:
+            break;
+
+        default: // one of the colors
+            week.set_selection_color(color_names[command - Config::CMD_SET_COL_WHITE]);
+            break;
+    }
+
+    if (done && fits) {
+        week.end_selection();
+        current_mode = MD_WEEK;
+    }
+
+    return fits;
+}
+
+// private
+void Ui::run_rename_command(int command) {
+    switch (command) {
+        case Config::CMD_CONFIRM_RENAME:
+            week.rename_block(rename_text);
+            current_mode = MD_WEEK;
+            break;
+        case Config::CMD_CANCEL_RENAME:
+            current_mode = MD_WEEK;
+            break;
+        case Config::CMD_CLEAR_RENAME:
+            rename_text = "";
+            break;
+    }
+}
+
+// private
+void Ui::enter_search() {
+    search_origin_day = week.get_focus_day();
+    search_origin_id = week.block_focused()? week.get_focused_block().get_id() : 0;
+
+    current_mode = MD_SEARCH;
+    rename_text = "";
+    search_results.clear();
+    search_pos = 0;
+    keymaps[MD_SEARCH].reset();
+}
+
+// private
+void Ui::run_search_command(int command) {
+    switch (command) {
+        case Config::CMD_CONFIRM_RENAME: // the focus stays on the result
+            current_mode = MD_WEEK;
+            break;
+        case Config::CMD_CANCEL_RENAME:
+            week.focus_block(search_origin_day, search_origin_id);
+            current_mode = MD_WEEK;
+            break;
+        case Config::CMD_CLEAR_RENAME:
+            rename_text = "";
+            update_search();
+            break;
+
+        case Config::CMD_SEARCH_NEXT:
+        case Config::CMD_SEARCH_PREV:
+            if (search_results.empty()) break;
+
+            search_pos += (command == Config::CMD_SEARCH_NEXT)? 1 : search_results.size() - 1;
+            search_pos %= search_results.size();
+            focus_search_result();
+            break;
+    }
+}
+
+// private
+void Ui::update_search() {
+    std::vector<SearchIndex::hit> hits = search_index.query(rename_text, 100);
+    std::vector<std::pair<double, Block>> found;
+
+    for (const SearchIndex::hit& hit : hits) {
+        Block block;
+        if (database.find_block(hit.id, block)) found.push_back({ hit.score, block });
+    }
+
+    // equally good matches are ordered by how close they are to now
+    time_t now = time(0);
+    std::stable_sort(found.begin(), found.end(), [now](const auto& a, const auto& b) {
+        if (a.first != b.first) return a.first > b.first;
+        return std::abs(a.second.get_time_t_start() - now)
+             < std::abs(b.second.get_time_t_start() - now);
+    });
+
+    search_results.clear();
+    for (const auto& [score, block] : found) search_results.push_back(block);
+
+    search_pos = 0;
+    focus_search_result();
+}
+
+// private
+void Ui::focus_search_result() {
+    if (search_results.empty()) return;
+
+    const Block& block = search_results[search_pos];
+    week.focus_block(block.get_day(), block.get_id());
+}
+
+// private
+std::string Ui::get_search_str() const {
+    std::string str = " /" + rename_text;
+    if (rename_text.empty()) return str;
+    if (search_results.empty()) return str + "  no match";
+
+    const Block& block = search_results[search_pos];
+    char date[40];
+    struct tm start = block.get_t_start();
+    std::strftime(date, sizeof(date), config.date_format.c_str(), &start);
+
+    return str + "  [" + std::to_string(search_pos + 1) + "/"
+         + std::to_string(search_results.size()) + "] " + block.get_title()
+         + "  " + date + " " + block.get_t_start_hour_str();
+}
+
+// private
+void Ui::type_rename_keys(const std::vector<int>& keys) {
+    for (int key : keys) {
+        if (key == KEY_BACKSPACE) {
+            // drop the whole last char, not just its last byte
+            while (!rename_text.empty() && (rename_text.back() & 0xc0) == 0x80)
+                rename_text.pop_back();
+            if (!rename_text.empty()) rename_text.pop_back();
+        }
+        else if (key >= 32 && key < 256 && key != 127) rename_text += (char) key;
+    }
+}
+
 void Ui::draw_bottom_bar(int height, int width) {
-    std::string str_status, str_link, str_keys;
+    std::string str_status, str_link, str_keys, str_bytes;
 
     str_status = "";
     int col_status = 0;
@@ -244,48 +950,116 @@ void Ui::draw_bottom_bar(int height, int width) {
     switch(current_mode) {
         case MD_WEEK:
             str_status = " NORMAL ";
-            col_status = config.num({"ui", "colors", "status_normal"});
+            col_status = config.colors.status_normal;
             break;
         case MD_WEEK_RENAME:
             str_status = " RENAME ";
-            col_status = config.num({"ui", "colors", "status_rename"});
+            col_status = config.colors.status_rename;
+            break;
+        case MD_OVERVIEW:
+            str_status = (overview.get_scale() == Overview::SCALE_MONTH)? " MONTH " : " YEAR ";
+            col_status = config.colors.status_normal;
+            break;
+        case MD_AGENDA:
+            str_status = " AGENDA ";
+            col_status = config.colors.status_normal;
+            break;
+        case MD_SEARCH:
+            str_status = " SEARCH ";
+            col_status = config.colors.status_rename;
+            break;
+        case MD_VISUAL:
+            str_status = " VISUAL ";
+            col_status = config.colors.status_rename;
+            break;
+        case MD_TEMPLATE:
+            str_status = " TEMPLATE ";
+            col_status = config.colors.status_rename;
             break;
+        case MD_GO_TO:
+            str_status = " GO TO ";
+            col_status = config.colors.status_rename;
+            break;
+        default: break;
     }
 
-    str_keys = " " + key_sequence;
+    if (current_mode == MD_WEEK_RENAME) str_keys = " " + rename_text;
+    else if (current_mode == MD_SEARCH) str_keys = get_search_str();
+    else if (current_mode == MD_TEMPLATE) str_keys = " " + template_prompt + rename_text;
+    else if (current_mode == MD_GO_TO) str_keys = " go to date: " + rename_text;
+    else if (!notice.empty()) str_keys = " " + notice;
+    else if (current_mode == MD_OVERVIEW && !keymaps[current_mode].is_pending())
+        str_keys = " " + overview.get_focus_summary();
+    else if (current_mode == MD_AGENDA && !keymaps[current_mode].is_pending())
+        str_keys = " " + agenda.get_focus_summary();
+    else if (current_mode == MD_VISUAL && !keymaps[current_mode].is_pending())
+        str_keys = " " + std::to_string(week.get_selection_count()) + " selected";
+    else str_keys = " " + keymaps[current_mode].get_pending_str();
 
-    str_link = week.get_current_link();
+    str_link = (current_mode == MD_OVERVIEW || current_mode == MD_AGENDA)?
+               "" : week.get_current_link();
     if (!str_link.empty()) str_link = " "+str_link+" ";
 
+    // size of the last frame that was sent to the terminal (for debugging)
+    if (config.show_frame_bytes)
+        str_bytes = " " + std::to_string(last_frame_bytes) + "B ";
+
     str_status = str_status.substr(0, width);
     str_keys   = str_keys  .substr(0, width);
     str_link   = str_link  .substr(0, width);
+    str_bytes  = str_bytes .substr(0, width);
 
     int col_keys = 8;
     int col_link = week.get_current_link_col();
 
-    attron(A_BOLD);
+    // nothing changed since the last frame, so the window stays as it is
+    std::string bar_state = str_status + "\n" + str_keys + "\n" + str_link + "\n"
+                          + str_bytes + "\n" + std::to_string(col_status) + "\n"
+                          + std::to_string(col_link) + "\n" + std::to_string(width);
+    if (bar_state == last_bar_state) return;
+    last_bar_state = bar_state;
+
+    werase(bar_win);
+    wattron(bar_win, A_BOLD);
 
     // fill the bottom with black color
-    attron(COLOR_PAIR(col_keys));
+    wattron(bar_win, COLOR_PAIR(col_keys));
     std::string spaces(width, ' ');
-    mvprintw(height - 1, 0, "%s", spaces.c_str());
-    attroff(COLOR_PAIR(col_keys));
+    mvwaddnstr(bar_win, 0, 0, spaces.c_str(), width - 1); // last cell would scroll
+    wattroff(bar_win, COLOR_PAIR(col_keys));
 
     // print the current link
-    attron(COLOR_PAIR(col_link));
-    mvprintw(height - 1, width - str_link.size(), "%s", str_link.c_str());
-    attroff(COLOR_PAIR(col_link));
+    wattron(bar_win, COLOR_PAIR(col_link));
+    mvwaddstr(bar_win, 0, width - str_link.size(), str_link.c_str());
+    wattroff(bar_win, COLOR_PAIR(col_link));
+
+    // print the frame size
+    wattron(bar_win, COLOR_PAIR(col_keys));
+    mvwaddstr(bar_win, 0, width - str_link.size() - str_bytes.size(), str_bytes.c_str());
+    wattroff(bar_win, COLOR_PAIR(col_keys));
 
     // print key sequence
-    attron(COLOR_PAIR(col_keys));
-    mvprintw(height - 1, str_status.size(), "%s", str_keys.c_str());
-    attroff(COLOR_PAIR(col_keys));
+    wattron(bar_win, COLOR_PAIR(col_keys));
+    mvwaddstr(bar_win, 0, str_status.size(), str_keys.c_str());
+    wattroff(bar_win, COLOR_PAIR(col_keys));
 
     // write status
-    attron(COLOR_PAIR(col_status));
-    mvprintw(height - 1, 0, "%s", str_status.c_str());
-    attroff(COLOR_PAIR(col_status));
+    wattron(bar_win, COLOR_PAIR(col_status));
+    mvwaddstr(bar_win, 0, 0, str_status.c_str());
+    wattroff(bar_win, COLOR_PAIR(col_status));
+
+    wattroff(bar_win, A_BOLD);
+
+    wnoutrefresh(bar_win);
+}
+
+// private
+void Ui::dump_render_stats() const {
+    std::cout << " - Ui::dump_render_stats()" << std::endl;
+    std::cout << "frames sent: " << frame_count << std::endl;
+    std::cout << "bytes written: " << bytes_written << std::endl;
+    std::cout << "last frame bytes: " << last_frame_bytes << std::endl;
 
-    attroff(A_BOLD);
+    if (frame_count != 0)
+        std::cout << "average frame bytes: " << bytes_written / frame_count << std::endl;
 }
@@ -2,9 +2,26 @@
 
 #include "Database.h"
 #include "Week.h"
+#include "EventLoop.h"
+#include "Input.h"
+#include "Keymap.h"
+#include "ConfigWatcher.h"
+#include "Overview.h"
+#include "Agenda.h"
+#include "Scheduler.h"
+#include "Templates.h"
+#include "SearchIndex.h"
+#include "TermOutput.h"
 
 // #include "include/curses.h"
 #include <ncursesw/ncurses.h>
+#include <chrono>
+#include <deque>
+#include <csignal>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
 
 class Ui {
 public:
@@ -12,16 +29,86 @@ public:
     void main();
 private:
     std::vector<std::string> args;
+    std::filesystem::path config_path;
     Config config;
     Database database;
     Week week;
+    Overview overview;
+    Agenda agenda;
+    Scheduler scheduler;
+    Templates templates;
+    SearchIndex search_index;
 
-    enum en_mode { MD_WEEK, MD_WEEK_RENAME };
+    enum en_mode { MD_WEEK, MD_WEEK_RENAME, MD_OVERVIEW, MD_SEARCH, MD_VISUAL, MD_TEMPLATE,
+                   MD_AGENDA, MD_GO_TO, MD_COUNT };
     en_mode current_mode;
-    std::string key_sequence;
-    int time_since_last_key;
+    Keymap keymaps[MD_COUNT]; // the keybinds of each mode
+    std::string rename_text; // the new title typed so far (or the search query, or a name)
+
+    std::vector<Block> search_results; // best first
+    size_t search_pos; // the result the week is focused on
+    int search_origin_day, search_origin_id; // the focus before searching, for cancel
+    int template_command; // what the name typed in template mode is for
+    int template_count; // how many times in a row it is applied
+    std::string template_prompt; // shown before the name
+    std::deque<int> pending_keys; // drained from the input queue, not handled yet
+
+    EventLoop events;
+    Input input; // keys decoded on their own thread
+    ConfigWatcher config_watcher; // reparses the config when it is saved
+    std::string notice; // shown in the bar until the next key
+    int minute_timer_fd; // fires on every minute boundary (for the today cursor)
+    int winch_fd; // signalfd for terminal resizes
+    bool quitting; // set once the quit key is pressed
+    bool redraw; // whether something happened that could change the screen
+
+    WINDOW* bar_win; // the bottom bar
+    std::string last_bar_state; // everything the bar showed when it was last drawn
+
+    size_t bytes_written; // total bytes sent to the terminal
+    size_t last_frame_bytes; // bytes sent by the last frame that sent anything
+    size_t frame_count; // frames that sent anything
 
     void init_ncurses();
-    bool draw_cycle(); // returns true if program should exit
+    void init_events(); // register the keyboard, minute timer and resize signal
+    void read_input(); // handle all keys the input thread queued
+    int get_wait_timeout() const; // ms until the key sequence expires (-1 if it can't)
+    // compile the keybinds of a config, throws if two of one mode are bound to the same keys
+    static void build_keymaps(const Config& cfg, Keymap* maps);
+    static void bind_keys(Keymap& keymap, const Config& cfg, int command);
+    void reload_config(); // swap in the config the watcher parsed
+    void resize(); // recreate windows after the terminal changed size
+    void sync_terminal_size(); // tell ncurses the size the terminal has now, then resize
+    void repaint(); // redraw the whole screen next frame
+    void run_external(std::function<void()> action); // hand the terminal to another program
+    void draw(); // sends everything that changed to the terminal
+    bool handle_key(int key); // returns true if program should exit
+    bool handle_result(Keymap::en_result result); // of the current mode's keymap
+    // returns true if program should exit, counted is whether the count was typed
+    bool run_command(int command, int count, bool counted, const std::vector<int>& keys);
+    void enter_rename();
+    void open_overview(Overview::en_scale scale);
+    void schedule_tasks(); // fill the free time from the focused day on with the task file
+    void run_overview_command(int command, int count);
+    void open_agenda(); // from the focused block, or the focused day
+    void run_agenda_command(int command, int count);
+    void enter_template(int command, int count); // ask for the name of a template
+    void run_template_command(int command);
+    void enter_go_to(); // ask for a date
+    void run_go_to_command(int command);
+    void jump_to_match(int command, int count); // count matches on, or back
+    void jump_to_free_slot(int minutes, bool backward);
+    void enter_visual();
+    // edits go to all selected blocks, returns false if they didn't fit (nothing changed)
+    bool run_visual_command(int command, int count, const std::vector<int>& keys);
+    void run_rename_command(int command);
+    void type_rename_keys(const std::vector<int>& keys); // keys that aren't bound are text
+    void enter_search();
+    void run_search_command(int command);
+    void update_search(); // query again and focus the first result
+    void focus_search_result();
+    std::string get_search_str() const; // the prompt and the focused result, for the bar
+    int take_repeats(const std::vector<int>& keys); // drop and count queued repeats
     void draw_bottom_bar(int height, int width);
+    void dump_render_stats() const;
 };
@@ -1,33 +1,44 @@
 #include "Week.h"
 
+const time_t Week::ZOOM_TIME_PER_LINE[ZOOM_COUNT] = {
+    0, 30*60, 20*60, 15*60, 10*60, 5*60, 2*60, 60 };
+
 Week::Week() {
     database_ptr = nullptr;
     day_map = {};
-    focused_date_time = start_date_time = 0;
+    focused_day = start_day = 0;
     day_count = 0;
-    last_total_width = day_width = gap_width = target_gap_width = target_gap_width
-                     = day_start_t = day_end_t = 0;
+    zoom = scroll_line = 0;
+    zoom_anchor_row = last_focus_day = last_focus_line = -1;
+    selecting = false;
+    select_anchor = 0;
+    last_slot = -1;
+    last_slot_day = last_slot_id = 0;
+    last_total_width = last_height = day_width = gap_width = target_gap_width
+                     = target_day_width = day_start_t = day_end_t = 0;
 }
 
 Week::Week(Database *db_ptr, Config *cfg_ptr) {
-    time_t now = time(0);
-    struct tm tmp_tm = *std::localtime(&now);
-    tmp_tm.tm_hour = tmp_tm.tm_min = tmp_tm.tm_sec = 0;
-    focused_date_time = start_date_time = std::mktime(&tmp_tm);
+    focused_day = start_day = Calendar::today();
 
     day_map = {};
+    last_total_width = last_height = 0;
+    zoom = scroll_line = 0;
+    zoom_anchor_row = last_focus_day = last_focus_line = -1;
+    selecting = false;
+    select_anchor = 0;
+    last_slot = -1;
+    last_slot_day = last_slot_id = 0;
 
     database_ptr = db_ptr;
     config_ptr = cfg_ptr;
+    box_cache = BoxCache(cfg_ptr);
 
-    day_width = target_day_width = config_ptr->num({"ui", "target_day_width"});
-    gap_width = target_gap_width = config_ptr->num({"ui", "target_gap_width"});
+    day_width = target_day_width = config_ptr->target_day_width;
+    gap_width = target_gap_width = config_ptr->target_gap_width;
 
-    day_start_t = 60*60*config_ptr->num({"time", "day_start_hour"})
-                   + 60*config_ptr->num({"time", "day_start_minute"});
-
-    day_end_t = 60*60*config_ptr->num({"time", "day_end_hour"})
-                 + 60*config_ptr->num({"time", "day_end_minute"});
+    day_start_t = config_ptr->day_start;
+    day_end_t = config_ptr->day_end;
 }
 
 // public
@@ -35,6 +46,7 @@ void Week::draw(int height, int width, int top_y, int left_x) {
     // this will set the day and gap widths
     // and make sure the vector has all the days filled in
     resize_widths(width);
+    last_height = height;
 
     // some day columns will be 'inflated' to eliminate empty columns on right of screen
     int empty_cols = width - (day_count * (day_width + gap_width) - gap_width);
@@ -42,14 +54,187 @@ void Week::draw(int height, int width, int top_y, int left_x) {
     int big_inflation = small_inflation + 1;
     int days_big_inflated = empty_cols - day_count * small_inflation;
     // ^^^ the amount of days inflated by big_inflation
+
+    // windows of columns that went off screen are no longer needed
+    for (size_t col = day_count; col < column_vec.size(); col++)
+        if (column_vec[col].win != nullptr) delwin(column_vec[col].win);
+    column_vec.resize(day_count, { nullptr, 0, 0, 0, 0, INT_MIN, false, 0 });
+
+    // lay out the days in view first, how far they can scroll depends on the tallest
+    // (layouts are cached per zoom level, so this is only work for days new in view)
+    time_t time_per_line = ZOOM_TIME_PER_LINE[zoom];
+    int content_height = 0;
+
+    for (int col = 0; col < day_count; col++) {
+        int inflation = (col < days_big_inflated)? big_inflation : small_inflation;
+
+        Day* day = get_day(start_day + col);
+        day->layout(height, day_width + inflation, time_per_line);
+        content_height = std::max(content_height, day->get_content_height());
+    }
+
+    update_scroll(height - 1, content_height); // below the line with the date
+
+    time_t now = time(0);
+    int right_edge = left_x + width;
+
+    time_t select_first, select_last;
+    get_selection_range(select_first, select_last);
     
-    // go thru and draw all the days in the correct spot
-    for (time_t i = start_date_time; i < start_date_time + day_count*24*60*60; i += 24*60*60) {
-        int inflation = (i < days_big_inflated)? big_inflation : small_inflation;
+    // go thru and draw the days that changed in the correct spot
+    int i = start_day;
+    for (int col = 0; col < day_count; col++, i++) {
+        int inflation = (col < days_big_inflated)? big_inflation : small_inflation;
+        int this_day_width = day_width + inflation;
+
+        // one extra column for the cursor, unless it would be off screen
+        int win_width = std::min(this_day_width + 1, right_edge - left_x);
+
+        struct column& column = column_vec[col];
+        bool focused = (i == focused_day);
+        bool force = false;
+
+        if (column.win == nullptr || column.height != height || column.width != win_width
+            || column.top_y != top_y || column.left_x != left_x) {
+            if (column.win != nullptr) delwin(column.win);
+
+            column = { newwin(height, win_width, top_y, left_x),
+                       height, win_width, top_y, left_x, INT_MIN, false, 0 };
+            force = true;
+        }
+
+        if (column.day != i || column.focused != focused || column.scroll != scroll_line)
+            force = true;
+
+        Day* day = get_day(i);
+        day->set_selection(select_first, select_last); // marks it dirty if that changed
+
+        if (column.win != nullptr && (force || day->needs_redraw(now))) {
+            werase(column.win);
+            day->draw(column.win, height, this_day_width, time_per_line, scroll_line, focused);
+            wnoutrefresh(column.win); // pushed to the screen with the rest in doupdate
+        }
+
+        column.day = i;
+        column.focused = focused;
+        column.scroll = scroll_line;
+
+        left_x += this_day_width + gap_width;
+    }
+
+    prune_days();
+}
+
+// private
+void Week::update_scroll(int body_height, int content_height) {
+    Day* day = get_focused_day();
+    int focus_line = day->get_focus_line();
+
+    if (zoom_anchor_row != -1 && day->has_blocks()) {
+        // zoomed, the focused block stays where it was on screen
+        scroll_line = focus_line - zoom_anchor_row;
+    } else if (day->has_blocks()
+               && (focused_day != last_focus_day || focus_line != last_focus_line)) {
+        // the focus moved, scroll as little as possible to show it
+        int margin = std::min(3, body_height / 4);
+
+        if (focus_line < scroll_line + margin)
+            scroll_line = focus_line - margin;
+        else if (focus_line >= scroll_line + body_height - margin)
+            scroll_line = focus_line - body_height + margin + 1;
+    }
+
+    zoom_anchor_row = -1;
+    last_focus_day = focused_day;
+    last_focus_line = focus_line;
+
+    scroll_line = std::min(scroll_line, content_height - body_height);
+    scroll_line = std::max(scroll_line, 0);
+}
+
+// private
+void Week::prune_days() {
+    // a view's worth of days is kept on either side, for scrolling back
+    if ((int) day_map.size() <= 3 * day_count) return;
+
+    for (auto it = day_map.begin(); it != day_map.end(); ) {
+        if (it->first < start_day - day_count || it->first > get_end_day() + day_count)
+            it = day_map.erase(it);
+        else
+            it++;
+    }
+}
+
+// public
+void Week::zoom_by(int steps) {
+    // a zoom level is only useful if it shows more than fitting the day does
+    time_t fit_time_per_line = (day_end_t - day_start_t) / std::max(last_height - 2, 1);
+    int old_zoom = zoom;
+
+    for (; steps > 0; steps--) {
+        int next = zoom + 1;
+        if (zoom == 0)
+            while (next < ZOOM_COUNT && ZOOM_TIME_PER_LINE[next] >= fit_time_per_line) next++;
+
+        if (next < ZOOM_COUNT) zoom = next;
+    }
+
+    for (; steps < 0; steps++) {
+        if (zoom > 0) zoom--;
+        if (zoom > 0 && ZOOM_TIME_PER_LINE[zoom] >= fit_time_per_line) zoom = 0;
+    }
+
+    if (zoom != old_zoom && block_focused())
+        zoom_anchor_row = get_focused_day()->get_focus_line() - scroll_line;
+}
+
+// public
+void Week::zoom_fit() { zoom_by(-ZOOM_COUNT); }
+
+// public
+void Week::scroll_vertical(int lines) { scroll_line += lines; } // clamped when drawn
 
-        get_day(i)->draw(height, day_width + inflation, top_y, left_x, i == focused_date_time);
-        left_x += day_width + inflation + gap_width;
+// public
+void Week::scroll_lateral(int days) {
+    start_day += days;
+
+    // drag the focus along if it would leave the view
+    int distance = 0;
+    if (focused_day < start_day) distance = start_day - focused_day;
+    else if (focused_day > get_end_day()) distance = get_end_day() - focused_day;
+
+    if (distance != 0) move_focus(distance);
+}
+
+// public
+void Week::invalidate() {
+    for (struct column& column : column_vec) column.day = INT_MIN; // matches no day
+}
+
+// public
+void Week::apply_config(int changed) {
+    if (changed & Config::SEC_GLYPHS) box_cache.clear();
+
+    if (changed & Config::SEC_LAYOUT) {
+        target_day_width = config_ptr->target_day_width;
+        target_gap_width = config_ptr->target_gap_width;
+        last_total_width = 0; // find new day and gap widths on the next draw
     }
+
+    if (changed & (Config::SEC_TIME | Config::SEC_DAY_STYLE)) {
+        day_start_t = config_ptr->day_start;
+        day_end_t = config_ptr->day_end;
+
+        // days read these when they are made, so make them again (from the database,
+        // no block files are read), keeping the focused block
+        bool had_block = block_focused();
+        int focused_id = had_block? get_focused_block().get_id() : 0;
+
+        day_map.clear();
+        if (had_block) get_focused_day()->set_focus_id(focused_id);
+    }
+
+    invalidate();
 }
 
 // public
@@ -58,15 +243,16 @@ bool Week::new_block_above() {
     bool successful;
 
     if (get_focused_day()->has_blocks()) { // add above the focus
-        block_time = get_focused_day()->get_focused_block().get_time_t_start();
-        successful = database_ptr->new_block_above(block_time);
+        Block block = get_focused_day()->get_focused_block();
+        block_time = block.get_time_t_start();
+        successful = database_ptr->new_block_above(block_time, block.get_track());
     } else { // add at top of day
-        block_time = focused_date_time + day_start_t;
-        successful = database_ptr->new_block_below(block_time);
+        block_time = Calendar::midnight(focused_day) + day_start_t;
+        successful = database_ptr->new_block_below(block_time, 0);
     }
 
     if (successful) {
-        reload_day(focused_date_time);
+        reload_day(focused_day);
         // get_focused_day()->move_focus(-1);
     }
 
@@ -76,46 +262,93 @@ bool Week::new_block_above() {
 // public
 bool Week::new_block_below() {
     time_t block_time;
+    int track = 0;
 
-    if (get_focused_day()->has_blocks())
+    if (get_focused_day()->has_blocks()) {
         block_time = get_focused_day()->get_focused_block().get_time_t_end();
-    else
-        block_time = focused_date_time + day_start_t;
+        track = get_focused_day()->get_focused_block().get_track();
+    } else
+        block_time = Calendar::midnight(focused_day) + day_start_t;
 
-    if (database_ptr->new_block_below(block_time)) { // returns succesful bool
-        reload_day(focused_date_time);
-        get_focused_day()->move_focus(1);
+    if (database_ptr->new_block_below(block_time, track)) { // returns succesful bool
+        reload_day(focused_day);
+        get_focused_day()->set_focus_start(block_time, track);
         return true;
     } else return false;
 }
 
 // public
-bool Week::move_block_up() {
-    if (get_focused_day()->has_blocks()) {
-        Block block = get_focused_day()->get_focused_block();
+bool Week::new_block_beside() {
+    if (!block_focused()) return false;
 
-        if (database_ptr->move_block_up(block.get_time_t_start())) {
-            reload_day(block.get_date_time());
+    Block block = get_focused_block();
+    int track = database_ptr->new_block_beside(block.get_time_t_start(), block.get_track());
+    if (track < 0) return false;
 
-            return true;
-        }
-    }
+    reload_day(focused_day);
+    get_focused_day()->set_focus_start(block.get_time_t_start(), track);
+    return true;
+}
 
-    return false;
+// public
+bool Week::ripple_insert_below() {
+    time_t block_time = block_focused()? get_focused_block().get_time_t_end()
+                                       : Calendar::midnight(focused_day) + day_start_t;
+    int track = block_focused()? get_focused_block().get_track() : 0;
+
+    if (!database_ptr->ripple_insert(block_time, track)) return false;
+
+    reload_day(focused_day);
+    get_focused_day()->set_focus_start(block_time, track);
+    return true;
 }
 
 // public
-bool Week::move_block_down() {
-    if (get_focused_day()->has_blocks()) {
-        Block block = get_focused_day()->get_focused_block();
+bool Week::ripple_insert_above() {
+    time_t block_time = block_focused()? get_focused_block().get_time_t_start()
+                                       : Calendar::midnight(focused_day) + day_start_t;
+    int track = block_focused()? get_focused_block().get_track() : 0;
 
-        if (database_ptr->move_block_down(block.get_time_t_start())) {
-            reload_day(block.get_date_time());
-            return true;
-        }
-    }
+    if (!database_ptr->ripple_insert(block_time, track)) return false;
 
-    return false;
+    reload_day(focused_day);
+    get_focused_day()->set_focus_start(block_time, track);
+    return true;
+}
+
+// public
+void Week::ripple_remove() {
+    if (!block_focused()) return;
+
+    Block block = get_focused_block();
+    database_ptr->ripple_remove(block.get_time_t_start(), block.get_track());
+    reload_day(focused_day);
+}
+
+// public
+int Week::move_block_up(int minutes) {
+    if (!get_focused_day()->has_blocks()) return 0;
+
+    Block block = get_focused_day()->get_focused_block();
+
+    int moved = database_ptr->move_block_up(block.get_time_t_start(), block.get_track(),
+                                            minutes);
+    if (moved != 0) reload_day(block.get_day());
+
+    return moved;
+}
+
+// public
+int Week::move_block_down(int minutes) {
+    if (!get_focused_day()->has_blocks()) return 0;
+
+    Block block = get_focused_day()->get_focused_block();
+
+    int moved = database_ptr->move_block_down(block.get_time_t_start(), block.get_track(),
+                                              minutes);
+    if (moved != 0) reload_day(block.get_day());
+
+    return moved;
 }
 
 // public
@@ -126,10 +359,11 @@ bool Week::move_block_left() { return move_block_lateral(-1); }
 bool Week::move_block_lateral(int amt) {
     if (get_focused_day()->has_blocks()) {
         Block block = get_focused_day()->get_focused_block();
+        int track = block.get_track();
 
-        if (database_ptr->move_block_lateral(block.get_time_t_start(), amt)) {
-            reload_day(block.get_date_time());
-            reload_day(block.get_date_time() + amt*24*60*60);
+        if (database_ptr->move_block_lateral(block.get_time_t_start(), track, amt)) {
+            reload_day(block.get_day());
+            reload_day(block.get_day() + amt);
 
             move_focus(amt);
             get_focused_day()->set_focus_id(block.get_id());
@@ -141,53 +375,49 @@ bool Week::move_block_lateral(int amt) {
     return false;
 }
 
-bool Week::extend_top_up() {
-    if (get_focused_day()->has_blocks()) {
-        Block block = get_focused_day()->get_focused_block();
+int Week::extend_top_up(int minutes) {
+    if (!get_focused_day()->has_blocks()) return 0;
 
-        if (database_ptr->extend_top_up(block.get_time_t_start())) {
-            reload_day(block.get_date_time());
-            return true;
-        }
-    }
+    Block block = get_focused_day()->get_focused_block();
 
-    return false;
+    int moved = database_ptr->extend_top_up(block.get_time_t_start(), block.get_track(),
+                                            minutes);
+    if (moved != 0) reload_day(block.get_day());
+
+    return moved;
 }
-bool Week::extend_top_down() {
-    if (get_focused_day()->has_blocks()) {
-        Block block = get_focused_day()->get_focused_block();
+int Week::extend_top_down(int minutes) {
+    if (!get_focused_day()->has_blocks()) return 0;
 
-        if (database_ptr->extend_top_down(block.get_time_t_start())) {
-            reload_day(block.get_date_time());
-            return true;
-        }
-    }
+    Block block = get_focused_day()->get_focused_block();
 
-    return false;
+    int moved = database_ptr->extend_top_down(block.get_time_t_start(), block.get_track(),
+                                              minutes);
+    if (moved != 0) reload_day(block.get_day());
+
+    return moved;
 }
-bool Week::extend_bottom_up() {
-    if (get_focused_day()->has_blocks()) {
-        Block block = get_focused_day()->get_focused_block();
+int Week::extend_bottom_up(int minutes) {
+    if (!get_focused_day()->has_blocks()) return 0;
 
-        if (database_ptr->extend_bottom_up(block.get_time_t_start())) {
-            reload_day(block.get_date_time());
-            return true;
-        }
-    }
+    Block block = get_focused_day()->get_focused_block();
 
-    return false;
+    int moved = database_ptr->extend_bottom_up(block.get_time_t_start(), block.get_track(),
+                                               minutes);
+    if (moved != 0) reload_day(block.get_day());
+
+    return moved;
 }
-bool Week::extend_bottom_down() {
-    if (get_focused_day()->has_blocks()) {
-        Block block = get_focused_day()->get_focused_block();
+int Week::extend_bottom_down(int minutes) {
+    if (!get_focused_day()->has_blocks()) return 0;
 
-        if (database_ptr->extend_bottom_down(block.get_time_t_start())) {
-            reload_day(block.get_date_time());
-            return true;
-        }
-    }
+    Block block = get_focused_day()->get_focused_block();
 
-    return false;
+    int moved = database_ptr->extend_bottom_down(block.get_time_t_start(), block.get_track(),
+                                                 minutes);
+    if (moved != 0) reload_day(block.get_day());
+
+    return moved;
 }
 
 // public
@@ -195,8 +425,8 @@ bool Week::set_block_color(std::string col) {
     if (get_focused_day()->has_blocks()) {
         Block block = get_focused_day()->get_focused_block();
 
-        if (database_ptr->set_block_color(block.get_time_t_start(), col)) {
-            reload_day(block.get_date_time());
+        if (database_ptr->set_block_color(block.get_time_t_start(), block.get_track(), col)) {
+            reload_day(block.get_day());
             return true;
         }
     }
@@ -210,8 +440,8 @@ void Week::block_toggle_collapsible() {
 
     Block block = get_focused_day()->get_focused_block();
 
-    database_ptr->block_toggle_collapsible(block.get_time_t_start());
-    reload_day(block.get_date_time());
+    database_ptr->block_toggle_collapsible(block.get_time_t_start(), block.get_track());
+    reload_day(block.get_day());
 }
 
 // public
@@ -220,8 +450,8 @@ void Week::block_toggle_important() {
 
     Block block = get_focused_day()->get_focused_block();
 
-    database_ptr->block_toggle_important(block.get_time_t_start());
-    reload_day(block.get_date_time());
+    database_ptr->block_toggle_important(block.get_time_t_start(), block.get_track());
+    reload_day(block.get_day());
 }
 
 // public
@@ -229,13 +459,16 @@ void Week::edit_block_source() {
     if (!get_focused_day()->has_blocks()) return;
 
     Block block = get_focused_day()->get_focused_block();
-    time_t new_date_time = database_ptr->edit_block_source(block.get_time_t_start());
+    int new_day = Calendar::day_of(database_ptr->edit_block_source(block.get_time_t_start(),
+                                                                   block.get_track()));
 
-    reload_day(block.get_date_time());
-    reload_day(new_date_time);
+    // the file might be (or have become) a series, showing up on every day
+    reload_all();
+    reload_day(block.get_day());
+    reload_day(new_day);
 
     // track the edited block with focus
-    focused_date_time = new_date_time;
+    focused_day = new_day;
     set_focus_inbounds();
     get_focused_day()->set_focus_id(block.get_id());
 }
@@ -254,11 +487,11 @@ void Week::copy_block_lateral(int amt) {
     if (!get_focused_day()->has_blocks()) return;
     Block block = get_focused_day()->get_focused_block();
 
-    time_t target_start = block.get_time_t_start() + amt*24*60*60;
+    time_t target_start = Calendar::shift_days(block.get_time_t_start(), amt);
 
     if (database_ptr->copy_block(block, target_start)) {
-        reload_day(block.get_date_time());
-        focused_date_time = block.get_date_time();
+        reload_day(block.get_day());
+        focused_day = block.get_day();
         set_focus_inbounds();
         get_focused_day()->set_focus_id(block.get_id());
     }
@@ -277,23 +510,200 @@ void Week::copy_block_vertical(bool dir_down) {
     }
 
     if (database_ptr->copy_block(block, target_start)) {
-        reload_day(block.get_date_time());
-        focused_date_time = block.get_date_time();
+        reload_day(block.get_day());
+        focused_day = block.get_day();
         set_focus_inbounds();
         get_focused_day()->set_focus_id(block.get_id());
     }
 }
 
+// public
+void Week::start_selection() {
+    selecting = true;
+    select_anchor = block_focused()? get_focused_block().get_time_t_start()
+                                   : Calendar::midnight(focused_day);
+}
+
+// public
+void Week::end_selection() { selecting = false; }
+
+// public
+bool Week::is_selecting() const { return selecting; }
+
+// public
+int Week::get_selection_count() { return get_selection().size(); }
+
+// private
+void Week::get_selection_range(time_t& first, time_t& last) {
+    first = 1;
+    last = 0;
+    if (!selecting) return;
+
+    // a day without blocks selects all of it that is on the far side of the anchor
+    time_t focus;
+    if (block_focused()) focus = get_focused_block().get_time_t_start();
+    else if (Calendar::midnight(focused_day) > select_anchor)
+        focus = Calendar::midnight(focused_day + 1) - 1;
+    else focus = Calendar::midnight(focused_day);
+
+    first = std::min(select_anchor, focus);
+    last = std::max(select_anchor, focus);
+}
+
+// private
+std::vector<Block> Week::get_selected_blocks() {
+    time_t first, last;
+    get_selection_range(first, last);
+
+    return database_ptr->get_blocks_between(first, last);
+}
+
+// private
+std::vector<Database::block_key> Week::get_selection() {
+    std::vector<Database::block_key> keys;
+    for (const Block& block : get_selected_blocks())
+        keys.push_back({ block.get_time_t_start(), block.get_track() });
+
+    return keys;
+}
+
+// private
+void Week::reload_days(const std::vector<Database::block_key>& keys, int days) {
+    std::set<int> changed;
+
+    for (const Database::block_key& key : keys) {
+        changed.insert(Calendar::day_of(key.start));
+        changed.insert(Calendar::day_of(key.start) + days);
+    }
+
+    // each once, however many of its blocks changed
+    for (int day : changed)
+        if (day_map.count(day) != 0) reload_day(day);
+}
+
+// public
+bool Week::shift_selection(int days, int minutes) {
+    std::vector<Database::block_key> keys = get_selection();
+    if (!database_ptr->shift_blocks(keys, days, minutes)) return false;
+
+    bool had_block = block_focused();
+    time_t focus_start = had_block? get_focused_block().get_time_t_start() : 0;
+    int focus_track = had_block? get_focused_block().get_track() : 0;
+
+    reload_days(keys, days);
+
+    // the selection and the focus go where the blocks went
+    select_anchor = Calendar::shift_days(select_anchor, days) + 60 * minutes;
+
+    if (had_block) {
+        focus_start = Calendar::shift_days(focus_start, days) + 60 * minutes;
+        focused_day = Calendar::day_of(focus_start);
+        set_focus_inbounds();
+        get_focused_day()->set_focus_start(focus_start, focus_track);
+    } else {
+        focused_day += days;
+        set_focus_inbounds();
+    }
+
+    return true;
+}
+
+// public
+bool Week::copy_selection_lateral(int amt) {
+    std::vector<Database::block_key> keys = get_selection();
+    if (!database_ptr->copy_blocks(keys, amt, 0)) return false;
+
+    reload_days(keys, amt);
+    return true;
+}
+
+// public
+bool Week::copy_selection_vertical(bool dir_down) {
+    std::vector<Block> blocks = get_selected_blocks();
+    if (blocks.empty()) return false;
+
+    // on each day the copy keeps the gaps, and starts where the selected blocks of that day
+    // end (or ends where they start), a selection over days doesn't spill into the next
+    std::map<int, std::pair<time_t, time_t>> day_spans; // first start and last end by day
+
+    for (const Block& block : blocks) {
+        auto it = day_spans.try_emplace(block.get_day(), block.get_time_t_start(),
+                                        block.get_time_t_end()).first;
+        it->second.second = std::max(it->second.second, block.get_time_t_end());
+    }
+
+    std::vector<Database::block_key> keys, targets;
+    std::vector<int> minutes;
+
+    for (const Block& block : blocks) {
+        const auto& [first, last] = day_spans.at(block.get_day());
+        int shift = (dir_down? 1 : -1) * (int) ((last - first) / 60);
+
+        keys.push_back({ block.get_time_t_start(), block.get_track() });
+        targets.push_back({ block.get_time_t_start() + 60 * (time_t) shift, block.get_track() });
+        minutes.push_back(shift);
+    }
+
+    if (!database_ptr->copy_blocks(keys, minutes)) return false;
+
+    reload_days(targets, 0); // the days the copies landed on
+    return true;
+}
+
+// public
+void Week::set_selection_color(std::string col) {
+    std::vector<Database::block_key> keys = get_selection();
+
+    database_ptr->set_blocks_color(keys, col);
+    reload_days(keys, 0);
+}
+
+// public
+void Week::toggle_selection_important() {
+    bool all_important = true;
+    std::vector<Database::block_key> keys;
+
+    for (const Block& block : get_selected_blocks()) {
+        all_important = all_important && block.get_important();
+        keys.push_back({ block.get_time_t_start(), block.get_track() });
+    }
+
+    database_ptr->set_blocks_important(keys, !all_important);
+    reload_days(keys, 0);
+}
+
+// public
+void Week::toggle_selection_collapsible() {
+    bool all_collapsible = true;
+    std::vector<Database::block_key> keys;
+
+    for (const Block& block : get_selected_blocks()) {
+        all_collapsible = all_collapsible && block.get_collapsible();
+        keys.push_back({ block.get_time_t_start(), block.get_track() });
+    }
+
+    database_ptr->set_blocks_collapsible(keys, !all_collapsible);
+    reload_days(keys, 0);
+}
+
+// public
+void Week::remove_selection() {
+    std::vector<Database::block_key> keys = get_selection();
+
+    database_ptr->remove_blocks(keys);
+    reload_days(keys, 0);
+}
+
 // public
 void Week::reload_all() {
-    std::vector<time_t> date_times;
+    std::vector<int> days;
 
     for (const auto& kv : day_map) {
-        date_times.push_back(kv.first);
+        days.push_back(kv.first);
     }
 
-    for (time_t date : date_times) {
-        reload_day(date);
+    for (int day : days) {
+        reload_day(day);
     }
 }
 
@@ -308,7 +718,7 @@ void Week::undo() {
 
     // focused_date_time = datetime;
     // set_focus_inbounds();
-    // reload_day(focused_date_time);
+    // reload_day(focused_day);
     // get_focused_day()->set_focus_id(id);
 }
 
@@ -322,7 +732,7 @@ void Week::undo_redo_impl(std::tuple<time_t, int> tup) {
     const auto [datetime, id] = tup;
     if (datetime == 0) return;
 
-    focused_date_time = datetime;
+    focused_day = Calendar::day_of(datetime);
     set_focus_inbounds();
     reload_all();
     get_focused_day()->set_focus_id(id);
@@ -336,16 +746,18 @@ Block Week::get_focused_block() { return get_focused_day()->get_focused_block();
 
 // public
 void Week::rename_block(std::string new_title) {
-    database_ptr->rename_block(get_focused_day()->get_focus_time_start(), new_title);
-    reload_day(focused_date_time);
+    Block block = get_focused_block();
+    database_ptr->rename_block(block.get_time_t_start(), block.get_track(), new_title);
+    reload_day(focused_day);
 }
 
 // public
 void Week::remove_block() {
     if (!block_focused()) return;
 
-    database_ptr->remove_block(get_focused_day()->get_focus_time_start());
-    reload_day(focused_date_time);
+    Block block = get_focused_block();
+    database_ptr->remove_block(block.get_time_t_start(), block.get_track());
+    reload_day(focused_day);
 }
 
 // public
@@ -362,41 +774,45 @@ int Week::get_current_link_col() {
     Block::en_link_type type = get_focused_day()->get_focused_block().get_link_type();
 
     switch(type) {
-        case Block::LINK_HTTP: return config_ptr->num({"ui", "colors", "link_http"}); break;
-        case Block::LINK_TASK: return config_ptr->num({"ui", "colors", "link_task"}); break;
-        case Block::LINK_FILE: return config_ptr->num({"ui", "colors", "link_file"}); break;
+        case Block::LINK_HTTP: return config_ptr->colors.link_http; break;
+        case Block::LINK_TASK: return config_ptr->colors.link_task; break;
+        case Block::LINK_FILE: return config_ptr->colors.link_file; break;
         default:               return 0; break;
     }
 }
 
 // private
-void Week::reload_day(time_t date_time) {
-    int focus = get_day(date_time)->get_focus();
-    // day_map.erase(day_map.find(focused_date_time));
-    day_map.erase(day_map.find(date_time));
-    get_day(date_time)->set_focus(focus);
+void Week::reload_day(int day) {
+    int focus = get_day(day)->get_focus();
+    day_map.erase(day_map.find(day));
+    get_day(day)->set_focus(focus);
 }
 
 // private
-Day* Week::get_day(time_t date_time) {
-    if (day_map.find(date_time) == day_map.end()) {
-        // the day at this time needs to be initilized
-        day_map.insert(std::make_pair(
-            date_time, Day(database_ptr, config_ptr, date_time)));
+Day* Week::get_day(int day) {
+    auto it = day_map.find(day);
+    if (it == day_map.end()) {
+        // the day needs to be initilized
+        it = day_map.insert(std::make_pair(
+            day, Day(database_ptr, config_ptr, &box_cache, day))).first;
+
+        // lay it out right away, so focus moves into it land on the right block
+        if (last_height > 0)
+            it->second.layout(last_height, day_width, ZOOM_TIME_PER_LINE[zoom]);
     }
 
-    return &day_map.at(date_time); // segfault
+    return &it->second;
 }
 
 // private
-time_t Week::get_end_date_time() { return start_date_time + (day_count-1)*24*60*60; }
+int Week::get_end_day() { return start_day + day_count - 1; }
 
 // public
 void Week::integrity_check() const {
     for (const auto & [ date, day ] : day_map) {
-        if (date != day.get_date_time()) throw std::runtime_error
-            ("Week integrity_check: Day at time " + std::to_string(date)
-             + " has incorrect yday: " + std::to_string(day.get_date_time()));
+        if (date != day.get_day()) throw std::runtime_error
+            ("Week integrity_check: Day at " + std::to_string(date)
+             + " has incorrect day number: " + std::to_string(day.get_day()));
 
         day.integrity_check();
     }
@@ -405,29 +821,103 @@ void Week::integrity_check() const {
 // public
 void Week::move_focus(int distance) {
     int line = get_focused_day()->get_focus_line();
-    focused_date_time += distance*24*60*60;
+    focused_day += distance;
     get_focused_day()->set_focus_line(line);
 
     set_focus_inbounds();
 }
 
+// public
+void Week::focus_day(int day) { move_focus(day - focused_day); }
+
+// public
+void Week::focus_block(int day, int id) {
+    focus_day(day);
+    get_focused_day()->set_focus_id(id);
+}
+
+// public
+int Week::get_focus_day() { return focused_day; }
+
+// public
+bool Week::jump_to_match(Database::en_match match, bool backward, int count) {
+    Block like, found;
+    Database::block_key key = { Calendar::midnight(focused_day), -1 };
+
+    if (block_focused()) {
+        like = get_focused_block();
+        key = { like.get_time_t_start(), like.get_track() };
+    } else if (match != Database::MATCH_IMPORTANT) return false; // nothing to compare with
+
+    if (!database_ptr->find_match(key, backward, match, like, count, found)) return false;
+
+    focus_day(found.get_day());
+    get_focused_day()->set_focus_start(found.get_time_t_start(), found.get_track());
+    return true;
+}
+
+// public
+time_t Week::jump_to_free_slot(int minutes, bool backward) {
+    time_t duration = 60 * (time_t) minutes;
+    int focused_id = block_focused()? get_focused_block().get_id() : 0;
+    time_t from;
+
+    if (last_slot >= 0 && last_slot_day == focused_day && last_slot_id == focused_id) {
+        // on past the blocks around the last slot (found on every track, it is free on all)
+        std::vector<Block> around = backward?
+            database_ptr->get_blocks_before({ last_slot, -1 }, 1)
+          : database_ptr->get_blocks_after({ last_slot, -1 }, 1);
+
+        if (!around.empty() && around[0].get_day() == focused_day)
+            from = around[0].get_time_t_start();
+        else from = Calendar::midnight(focused_day + (backward? 0 : 1));
+    }
+    else if (block_focused()) {
+        Block block = get_focused_block();
+        from = backward? block.get_time_t_start() : block.get_time_t_end();
+    }
+    else from = Calendar::midnight(focused_day) + (backward? day_end_t : day_start_t);
+
+    time_t slot = database_ptr->find_free_slot_near(from, duration, backward);
+    if (slot < 0) return -1;
+
+    focus_near(Calendar::day_of(slot), slot);
+
+    last_slot = slot;
+    last_slot_day = focused_day;
+    last_slot_id = block_focused()? get_focused_block().get_id() : 0;
+    return slot;
+}
+
+// private
+void Week::focus_near(int day, time_t time) {
+    focus_day(day);
+
+    std::vector<Block> near = database_ptr->get_blocks_before({ time, -1 }, 1);
+    if (near.empty() || near[0].get_day() != day)
+        near = database_ptr->get_blocks_after({ time, -1 }, 1); // the first of the day
+
+    if (!near.empty() && near[0].get_day() == day)
+        get_focused_day()->set_focus_start(near[0].get_time_t_start(), near[0].get_track());
+}
+
 // private
 void Week::set_focus_inbounds() {
-    int start_diff = focused_date_time - start_date_time;
-    int end_diff = get_end_date_time() - focused_date_time;
+    int start_diff = focused_day - start_day;
+    int end_diff = get_end_day() - focused_day;
 
     if (start_diff < 0)
-        start_date_time += start_diff;
+        start_day += start_diff;
     else if (end_diff < 0)
-        start_date_time -= end_diff;
+        start_day -= end_diff;
 }
 
 // private
-Day* Week::get_focused_day() { return get_day(focused_date_time); }
+Day* Week::get_focused_day() { return get_day(focused_day); }
 
 // public
 void Week::move_block_focus(int distance) { 
-    get_day(focused_date_time)->move_focus(distance);
+    get_day(focused_day)->move_focus(distance);
 }
 
 // private
@@ -435,6 +925,7 @@ void Week::resize_widths(int total_width) {
     if (last_total_width == total_width) return;
 
     last_total_width = total_width;
+    Wrap::clear(); // titles are wrapped for the new column widths from now on
 
     day_width = target_day_width;
     gap_width = target_gap_width;
@@ -479,8 +970,8 @@ void Week::resize_widths(int total_width) {
 //public
 void Week::dump_info() const {
     std::cout << " - Week::dump_info()" << std::endl;
-    std::cout << "start date time: " << start_date_time << std::endl;
-    std::cout << "focused date time: " << focused_date_time << std::endl;
+    std::cout << "start day: " << start_day << std::endl;
+    std::cout << "focused day: " << focused_day << std::endl;
     std::cout << "day count: " << day_count << std::endl;
     std::cout << "last tot width: " << last_total_width << std::endl;
     std::cout << "day width: " << day_width << std::endl;
@@ -2,35 +2,71 @@
 
 #include "Day.h"
 #include "Database.h"
+#include "Wrap.h"
 
 #include <limits>
+#include <climits>
 #include <unordered_map>
+#include <map>
 #include <tuple>
+#include <set>
 
 // figuratively speaking. in reality it represents an arbitrary number of days
 class Week {
 private:
     Database *database_ptr; // pointer to the main task database
     Config *config_ptr; // pointer to the config table
-    std::unordered_map<time_t, Day> day_map;
-    Day* get_day(time_t date_time);
-    void reload_day(time_t date_time);
-
-    // struct tm start_date; // the day this 'week' start
-    time_t start_date_time;
-    time_t focused_date_time;
+    BoxCache box_cache; // box rows shared by all days
+    std::unordered_map<int, Day> day_map; // keyed by civil day number
+
+    struct column { // a window on screen that a day gets drawn into
+        WINDOW* win;
+        int height, width, top_y, left_x;
+        int day; // the day that was last drawn into it
+        bool focused; // whether that day was drawn focused
+        int scroll; // the line it was scrolled to
+    };
+    std::vector<column> column_vec; // the visible columns, left to right
+    Day* get_day(int day);
+    void reload_day(int day);
+
+    int start_day; // the first day displayed
+    int focused_day;
     int day_count;
+
+    static const int ZOOM_COUNT = 8;
+    static const time_t ZOOM_TIME_PER_LINE[ZOOM_COUNT]; // 0 fits the whole day on screen
+    int zoom; // index into ZOOM_TIME_PER_LINE
+    int scroll_line; // the first line of the days in view (shared by all columns)
+    int zoom_anchor_row; // row to keep the focused block on after zooming (-1 if none)
+    int last_focus_day, last_focus_line; // where the focus was when last drawn
+
+    bool selecting; // whether blocks are being selected, from the anchor to the focus
+    time_t select_anchor; // the start of the block focused when selecting began
+    void get_selection_range(time_t& first, time_t& last); // empty if not selecting
+    std::vector<Block> get_selected_blocks();
+    std::vector<Database::block_key> get_selection(); // where the selected blocks are
+    // reload each day these blocks are on once, and the days they were shifted to
+    void reload_days(const std::vector<Database::block_key>& keys, int days);
     
     int last_total_width; // the last width that was given to resize
+    int last_height; // the last height the days were drawn at
     int day_width, gap_width; // the width of the days and gaps between them (in columns)
     int target_day_width, target_gap_width; // the optimal day width we want to achieve (preconfigured)
     time_t day_start_t, day_end_t; // start and end times of the day (preconfigured)
 
     void resize_widths(int total_width); // resizes the sizing of colums to fit (returns number of days)
     void populate_vector(int day_count); // makes sure the vector has the correct size
-    time_t get_end_date_time(); // get the datetime of the last day that is displayed
+    int get_end_day(); // get the last day that is displayed
     void set_focus_inbounds(); // move the focus back into bounds if it wasn't
+    void update_scroll(int body_height, int content_height); // keep the focus in view
+    void prune_days(); // drop days far from the view, so scrolling doesn't pile them up
     void undo_redo_impl(std::tuple<time_t, int> tup); // move focus to this time
+    // the free slot the last jump found, and the focus it left (day and block id, or 0)
+    // a jump from that same focus goes on from the slot instead of the block
+    time_t last_slot;
+    int last_slot_day, last_slot_id;
+    void focus_near(int day, time_t time); // the last block on the day starting before time
     bool move_block_lateral(int amt);
     Day* get_focused_day();
 public:
@@ -38,9 +74,27 @@ public:
     Week();
     void move_focus(int distance); // focus the day this many away (right positive)
     void move_block_focus(int distance); // passed thru to the focused day
-
-    // draws the week over the screen
+    void focus_day(int day); // focus this civil day, scrolling it into view
+    void focus_block(int day, int id); // that day, and the block with this id on it
+    int get_focus_day(); // the focused civil day
+
+    // jumps, answered by the database without going thru the days in between
+    // only the day landed on is built
+    // to the count-th match that way (or the last one), false if there is none
+    bool jump_to_match(Database::en_match match, bool backward, int count);
+    // the next (or previous) stretch this long within the day hours that is free on every
+    // track, the block before it gets the focus, returns its start (-1 if none in a year)
+    time_t jump_to_free_slot(int minutes, bool backward);
+
+    void zoom_by(int steps); // positive zooms in, towards fewer minutes per line
+    void zoom_fit(); // fit whole days on screen again
+    void scroll_vertical(int lines); // scroll the view without moving the focus
+    void scroll_lateral(int days); // scroll the view, the focus is kept inside it
+
+    // draws the days that changed into their windows (without doupdate)
     void draw(int height, int width, int y_corner, int x_corner);
+    void invalidate(); // redraw every day next frame
+    void apply_config(int changed); // drop what depends on these Config::SEC_ sections
 
     // getters
     Block get_focused_block();
@@ -52,16 +106,22 @@ public:
     void reload_all();
     bool new_block_below();
     bool new_block_above();
-
-    bool move_block_down();
-    bool move_block_up();
+    bool new_block_beside(); // on another track, overlapping the focused block
+    // the same, but the rest of the day moves down to make room
+    bool ripple_insert_below();
+    bool ripple_insert_above();
+    void ripple_remove(); // and the rest of the day moves up into the room it leaves
+
+    // these move by up to this many minutes and return how many they moved
+    int move_block_down(int minutes = 1);
+    int move_block_up(int minutes = 1);
     bool move_block_right();
     bool move_block_left();
 
-    bool extend_top_up();
-    bool extend_top_down();
-    bool extend_bottom_up();
-    bool extend_bottom_down();
+    int extend_top_up(int minutes = 1);
+    int extend_top_down(int minutes = 1);
+    int extend_bottom_up(int minutes = 1);
+    int extend_bottom_down(int minutes = 1);
 
     bool set_block_color(std::string col);
 
@@ -73,6 +133,21 @@ public:
     void copy_block_lateral(int amt);
     void copy_block_vertical(bool dir_down);
 
+    // every block starting between the focus now and the one as it moves is selected
+    void start_selection();
+    void end_selection();
+    bool is_selecting() const;
+    int get_selection_count();
+
+    // these change the whole selection as one undo, moves and copies only if all fit
+    bool shift_selection(int days, int minutes); // the selection moves along
+    bool copy_selection_lateral(int amt);
+    bool copy_selection_vertical(bool dir_down); // right below or above the selection
+    void set_selection_color(std::string col);
+    void toggle_selection_important(); // all of them, or none if all of them were
+    void toggle_selection_collapsible();
+    void remove_selection();
+
     std::string get_current_link();
     int get_current_link_col();
 
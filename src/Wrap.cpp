@@ -0,0 +1,116 @@
+#include "Wrap.h"
+
+static const size_t MAX_TEXTS = 4096; // per width, renames put a new title in on every key
+
+std::unordered_map<int, std::unordered_map<std::string, std::vector<std::string>>>
+    Wrap::cache = {};
+
+// public
+const std::vector<std::string>& Wrap::wrap(const std::string& text, int width) {
+    std::unordered_map<std::string, std::vector<std::string>>& width_cache = cache[width];
+
+    auto it = width_cache.find(text);
+    if (it == width_cache.end()) {
+        if (width_cache.size() >= MAX_TEXTS) width_cache.clear(); // just start over
+        it = width_cache.emplace(text, wrap_impl(text, width)).first;
+    }
+
+    return it->second;
+}
+
+// public
+int Wrap::display_width(const std::string& text) {
+    int ret = 0;
+    for (const grapheme& gr : split_graphemes(text)) ret += gr.width;
+    return ret;
+}
+
+// public
+void Wrap::clear() { cache.clear(); }
+
+// private
+std::vector<Wrap::grapheme> Wrap::split_graphemes(const std::string& text) {
+    std::vector<grapheme> ret;
+    std::mbstate_t state = std::mbstate_t();
+    bool joining = false; // the last codepoint was a zero width joiner
+
+    size_t i = 0;
+    while (i < text.size()) {
+        wchar_t wc;
+        size_t len = std::mbrtowc(&wc, text.data() + i, text.size() - i, &state);
+
+        if (len == (size_t) -1 || len == (size_t) -2) {
+            // invalid or cut off sequence, so just treat the byte as one column
+            state = std::mbstate_t();
+            ret.push_back({ text.substr(i, 1), 1 });
+            joining = false;
+            i++;
+            continue;
+        }
+        if (len == 0) len = 1; // embedded null character
+
+        int width = wcwidth(wc);
+        if (width < 0) width = 1; // unprintable, but it still takes up space
+
+        // combining marks and joined codepoints belong to the previous cluster
+        if (!ret.empty() && (width == 0 || joining)) {
+            ret.back().bytes += text.substr(i, len);
+        } else {
+            ret.push_back({ text.substr(i, len), width });
+        }
+
+        joining = (wc == 0x200D);
+        i += len;
+    }
+
+    return ret;
+}
+
+// private
+std::vector<std::string> Wrap::wrap_impl(const std::string& text, int width) {
+    if (width < 1) return { "" };
+
+    std::vector<grapheme> graphemes = split_graphemes(text);
+    std::vector<std::string> lines;
+
+    size_t line_start = 0; // index of the first grapheme on the current line
+    while (line_start < graphemes.size()) {
+        // wrapped lines don't start with the space that was broken at
+        if (!lines.empty()) {
+            while (line_start < graphemes.size() && graphemes[line_start].bytes == " ")
+                line_start++;
+            if (line_start == graphemes.size()) break;
+        }
+
+        int line_width = 0;
+        size_t end = line_start; // one past the last grapheme that fits
+        size_t last_space = std::string::npos;
+
+        while (end < graphemes.size() && line_width + graphemes[end].width <= width) {
+            if (graphemes[end].bytes == " ") last_space = end;
+            line_width += graphemes[end].width;
+            end++;
+        }
+
+        if (end == line_start) end++; // cluster wider than the line, give it its own
+
+        size_t next_start = end;
+
+        // if we would cut a word in half, break at the last space instead
+        if (end < graphemes.size() && graphemes[end].bytes != " "
+            && last_space != std::string::npos && last_space > line_start) {
+            end = last_space;
+            next_start = last_space + 1;
+        }
+
+        std::string line = "";
+        for (size_t i = line_start; i < end; i++) line += graphemes[i].bytes;
+
+        lines.push_back(line);
+        line_start = next_start;
+    }
+
+    if (lines.empty()) lines.push_back("");
+
+    return lines;
+}
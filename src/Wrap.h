@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cwchar>
+
+// line wraps text by terminal display width, results are shared between all days
+// (the week drops them when its column widths change, so only a layout's widths are kept)
+class Wrap {
+public:
+    // the text split into lines at most width columns wide (never empty)
+    // the reference is only good until the next wrap or clear, copy what is kept
+    static const std::vector<std::string>& wrap(const std::string& text, int width);
+    static int display_width(const std::string& text); // columns taken up on screen
+    static void clear(); // drop all cached wraps
+
+private:
+    struct grapheme {
+        std::string bytes; // the utf-8 bytes of the whole cluster
+        int width; // display width of the cluster in columns
+    };
+
+    static std::vector<grapheme> split_graphemes(const std::string& text);
+    static std::vector<std::string> wrap_impl(const std::string& text, int width);
+
+    // width -> title -> wrapped lines
+    static std::unordered_map<int,
+        std::unordered_map<std::string, std::vector<std::string>>> cache;
+};